@@ -22,11 +22,13 @@ echo.
 :: Set output name
 set TARGET=chess_engine.exe
 set TEST_TARGET=perft_test.exe
+set BOARD_TEST_TARGET=board_test.exe
 set FLAGS=-std=c++17 -O3 -Wall -Iengine
 
 :: Source files
-set SRCS=engine\main.cpp engine\board\Board.cpp engine\movegen\MoveGen.cpp engine\eval\Eval.cpp engine\search\Search.cpp engine\cli\CLI.cpp engine\util\PGN.cpp
-set TEST_SRCS=tests\perft_test.cpp engine\board\Board.cpp engine\movegen\MoveGen.cpp
+set SRCS=engine\main.cpp engine\board\Board.cpp engine\board\Attacks.cpp engine\movegen\MoveGen.cpp engine\eval\Eval.cpp engine\search\Search.cpp engine\search\MovePicker.cpp engine\cli\CLI.cpp engine\util\PGN.cpp engine\util\FenFile.cpp
+set TEST_SRCS=tests\perft_test.cpp engine\board\Board.cpp engine\board\Attacks.cpp engine\movegen\MoveGen.cpp
+set BOARD_TEST_SRCS=tests\board_test.cpp engine\board\Board.cpp engine\board\Attacks.cpp engine\movegen\MoveGen.cpp engine\eval\Eval.cpp engine\search\MovePicker.cpp
 
 :: Parse arguments
 if "%1"=="test" goto build_test
@@ -49,7 +51,7 @@ if "%1"=="" pause
 goto end
 
 :build_test
-echo Building perft tests...
+echo Building tests...
 g++ %FLAGS% -o %TEST_TARGET% %TEST_SRCS%
 if errorlevel 1 (
     echo.
@@ -57,9 +59,20 @@ if errorlevel 1 (
     pause
     exit /b 1
 )
+g++ %FLAGS% -o %BOARD_TEST_TARGET% %BOARD_TEST_SRCS%
+if errorlevel 1 (
+    echo.
+    echo TEST BUILD FAILED.
+    pause
+    exit /b 1
+)
 echo Running tests...
 echo.
 %TEST_TARGET%
+echo.
+%TEST_TARGET% --magic
+echo.
+%BOARD_TEST_TARGET%
 pause
 goto end
 
@@ -67,6 +80,7 @@ goto end
 echo Cleaning build artifacts...
 if exist %TARGET% del /f %TARGET%
 if exist %TEST_TARGET% del /f %TEST_TARGET%
+if exist %BOARD_TEST_TARGET% del /f %BOARD_TEST_TARGET%
 echo Done.
 goto end
 
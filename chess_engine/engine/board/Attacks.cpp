@@ -0,0 +1,101 @@
+#include "Attacks.h"
+
+namespace Attacks {
+
+bool USE_PEXT = false;
+Magic ROOK_MAGICS[64];
+Magic BISHOP_MAGICS[64];
+
+// Every square's slice, back to back: 2^(relevant bits) entries each
+static Bitboard rookTable[0x19000];
+static Bitboard bishopTable[0x1480];
+
+// Ray-walk attacks for the four directions starting at firstDir (0 rook,
+// 4 bishop); only used to fill the tables
+static Bitboard slidingAttacks(int firstDir, Square s, Bitboard occ) {
+    Bitboard b = 0;
+    for (int d=firstDir; d<firstDir+4; d++) b |= rayAttacks(d, s, occ);
+    return b;
+}
+
+// xorshift64*; candidates AND three outputs together, since magics with
+// few set bits are found much sooner
+struct Rng {
+    uint64_t s;
+    uint64_t next() { s ^= s >> 12; s ^= s << 25; s ^= s >> 27; return s * 2685821657736338717ULL; }
+    uint64_t sparse() { return next() & next() & next(); }
+};
+
+// Generator seed per rank, picked by trying seeds offline so that both
+// piece types find all their magics quickly
+static constexpr uint64_t SEEDS[8] = {728, 2985, 110, 2501, 1289, 2821, 1699, 255};
+
+static void initMagics(Magic* magics, Bitboard* table, int firstDir) {
+    static Bitboard occupancy[4096], reference[4096];
+    int epoch[4096] = {}, attempt = 0;
+
+    for (Square s=0; s<64; s++) {
+        Magic& m = magics[s];
+        // Edge squares never block anything further along the ray
+        Bitboard edges = ((RANK_1_BB | RANK_1_BB<<56) & ~(RANK_1_BB << (8*(s/8))))
+                       | ((FILE_A_BB | FILE_H_BB) & ~(FILE_A_BB << (s%8)));
+        m.mask = slidingAttacks(firstDir, s, 0) & ~edges;
+        m.shift = 64 - popcount(m.mask);
+        m.attacks = table;
+
+        // Every subset of the mask (carry-rippler) with its attack set
+        int size = 0;
+        Bitboard b = 0;
+        do {
+            occupancy[size] = b;
+            reference[size] = slidingAttacks(firstDir, s, b);
+            size++;
+            b = (b - m.mask) & m.mask;
+        } while (b);
+        table += size;
+
+        if (USE_PEXT) {
+            for (int i=0; i<size; i++) m.attacks[m.index(occupancy[i])] = reference[i];
+            continue;
+        }
+
+        // Try candidates until no two subsets with different attacks share
+        // an index. epoch marks the entries written by the current attempt,
+        // so the slice needn't be cleared between attempts.
+        Rng rng{SEEDS[s/8]};
+        for (int i=0; i<size; ) {
+            do m.magic = rng.sparse(); while (popcount((m.mask * m.magic) >> 56) < 6);
+            for (++attempt, i=0; i<size; i++) {
+                unsigned idx = m.index(occupancy[i]);
+                if (epoch[idx] < attempt) {
+                    epoch[idx] = attempt;
+                    m.attacks[idx] = reference[i];
+                } else if (m.attacks[idx] != reference[i]) break;
+            }
+        }
+    }
+}
+
+// BMI2 present and PEXT not microcoded (it is on AMD before Zen 3)
+static bool fastPext() {
+#if ATTACKS_HAS_PEXT
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2")
+        && !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2");
+#else
+    return false;
+#endif
+}
+
+void init(bool allowPext) {
+    static bool done = false;
+    if (done) return;
+    USE_PEXT = allowPext && fastPext();
+    initMagics(ROOK_MAGICS, rookTable, 0);
+    initMagics(BISHOP_MAGICS, bishopTable, 4);
+    done = true;
+}
+
+const char* backendName() { return USE_PEXT ? "pext" : "magic"; }
+
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include "Board.h"
+
+namespace Attacks {
+
+// Queen directions as (file, rank) steps: first four orthogonal, last four
+// diagonal. Even directions increase the square index and d^1 is the
+// opposite of d.
+inline constexpr int DIRS[8][2] = {{1,0},{-1,0},{0,1},{0,-1},{1,1},{-1,-1},{-1,1},{1,-1}};
+
+struct Tables {
+    Bitboard knight[64];
+    Bitboard king[64];
+    Bitboard pawn[2][64];    // squares a pawn of each color attacks
+    Bitboard ray[8][64];     // empty-board ray from a square, square excluded
+    Bitboard between[64][64]; // squares strictly between two aligned squares
+    Bitboard line[64][64];    // whole line through two aligned squares
+};
+
+// Squares reached from s by single (file, rank) steps, dropping any that
+// fall off the board
+constexpr Bitboard stepAttacks(Square s, const int (*steps)[2], int n) {
+    Bitboard b = 0;
+    for (int i=0;i<n;i++) {
+        int f = s%8+steps[i][0], r = s/8+steps[i][1];
+        if (f>=0&&f<8&&r>=0&&r<8) b |= squareBB(r*8+f);
+    }
+    return b;
+}
+
+constexpr Tables buildTables() {
+    Tables t{};
+    const int knightSteps[8][2] = {{1,2},{2,1},{2,-1},{1,-2},{-1,-2},{-2,-1},{-2,1},{-1,2}};
+    const int pawnSteps[2][2][2] = {{{-1,1},{1,1}}, {{-1,-1},{1,-1}}};
+    for (Square s=0;s<64;s++) {
+        t.knight[s] = stepAttacks(s, knightSteps, 8);
+        t.king[s] = stepAttacks(s, DIRS, 8);
+        t.pawn[WHITE][s] = stepAttacks(s, pawnSteps[WHITE], 2);
+        t.pawn[BLACK][s] = stepAttacks(s, pawnSteps[BLACK], 2);
+        for (int d=0;d<8;d++) {
+            Bitboard ray = 0;
+            int f = s%8+DIRS[d][0], r = s/8+DIRS[d][1];
+            for (; f>=0&&f<8&&r>=0&&r<8; f+=DIRS[d][0], r+=DIRS[d][1]) {
+                Square to = r*8+f;
+                t.between[s][to] = ray;
+                ray |= squareBB(to);
+            }
+            t.ray[d][s] = ray;
+        }
+    }
+    // Lines: both rays through s in the direction of each ray square
+    for (Square s=0;s<64;s++)
+        for (int d=0;d<8;d++)
+            for (Bitboard b=t.ray[d][s]; b; b&=b-1) {
+                Square to = __builtin_ctzll(b);
+                t.line[s][to] = t.ray[d][s] | t.ray[d^1][s] | squareBB(s);
+            }
+    return t;
+}
+
+inline constexpr Tables TABLES = buildTables();
+
+// Attacks along one direction, stopping at (and including) the first piece
+inline Bitboard rayAttacks(int d, Square s, Bitboard occ) {
+    Bitboard ray = TABLES.ray[d][s];
+    Bitboard blockers = ray & occ;
+    if (blockers) ray ^= TABLES.ray[d][(d&1) ? msb(blockers) : lsb(blockers)];
+    return ray;
+}
+
+// PEXT is only emitted through inline asm, so one binary built without
+// -mbmi2 can still use it on hosts that have it
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ATTACKS_HAS_PEXT 1
+inline Bitboard pext(Bitboard b, Bitboard mask) {
+    Bitboard r;
+    asm("pextq %2, %1, %0" : "=r"(r) : "r"(b), "r"(mask));
+    return r;
+}
+#else
+#define ATTACKS_HAS_PEXT 0
+#endif
+
+// Set by init() when the CPU has fast PEXT; the tables are then indexed by
+// the blockers' bits packed down (PEXT) instead of by the magic product
+extern bool USE_PEXT;
+
+// Fancy magic bitboards for sliders: the relevant blockers (mask) times the
+// magic, shifted down, index this square's slice of a shared attack table
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard* attacks;
+    unsigned shift;
+    unsigned index(Bitboard occ) const {
+#if ATTACKS_HAS_PEXT
+        if (USE_PEXT) return unsigned(pext(occ, mask));
+#endif
+        return unsigned(((occ & mask) * magic) >> shift);
+    }
+};
+
+extern Magic ROOK_MAGICS[64];
+extern Magic BISHOP_MAGICS[64];
+
+// Picks the backend and fills the attack tables (magics take ~40 ms to
+// find, PEXT needs none). allowPext=false forces the magic backend. Called
+// from Board::initZobrist, so any code holding a Board can use the lookups;
+// later calls return at once.
+void init(bool allowPext = true);
+// "pext" or "magic"
+const char* backendName();
+
+}
+
+constexpr Bitboard FILE_A_BB = 0x0101010101010101ULL;
+constexpr Bitboard FILE_H_BB = FILE_A_BB << 7;
+constexpr Bitboard RANK_1_BB = 0xFFULL;
+
+// Rank r (0-7) as seen from color C's side of the board
+template<Color C> constexpr Bitboard relativeRankBB(int r) {
+    return RANK_1_BB << (8 * (C==WHITE ? r : 7-r));
+}
+
+// Shift every square one step in direction D (a square offset: +-8 for
+// ranks, +-7/+-9 for diagonals), dropping squares that would wrap a file
+template<int D> constexpr Bitboard shiftBB(Bitboard b) {
+    return D==8  ? b << 8 : D==-8 ? b >> 8
+         : D==9  ? (b & ~FILE_H_BB) << 9 : D==7  ? (b & ~FILE_A_BB) << 7
+         : D==-7 ? (b & ~FILE_H_BB) >> 7 : (b & ~FILE_A_BB) >> 9;
+}
+
+inline Bitboard knightAttacks(Square s) { return Attacks::TABLES.knight[s]; }
+inline Bitboard kingAttacks(Square s) { return Attacks::TABLES.king[s]; }
+inline Bitboard pawnAttacks(Color c, Square s) { return Attacks::TABLES.pawn[c][s]; }
+inline Bitboard betweenBB(Square a, Square b) { return Attacks::TABLES.between[a][b]; }
+inline Bitboard lineBB(Square a, Square b) { return Attacks::TABLES.line[a][b]; }
+
+inline Bitboard rookAttacks(Square s, Bitboard occ) {
+    const Attacks::Magic& m = Attacks::ROOK_MAGICS[s];
+    return m.attacks[m.index(occ)];
+}
+inline Bitboard bishopAttacks(Square s, Bitboard occ) {
+    const Attacks::Magic& m = Attacks::BISHOP_MAGICS[s];
+    return m.attacks[m.index(occ)];
+}
+inline Bitboard queenAttacks(Square s, Bitboard occ) { return rookAttacks(s, occ) | bishopAttacks(s, occ); }
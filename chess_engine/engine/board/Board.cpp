@@ -1,5 +1,8 @@
 #include "Board.h"
-#include <sstream>
+#include "Attacks.h"
+#include "../eval/PST.h"
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <cstring>
 #include <random>
@@ -11,20 +14,37 @@ uint64_t Board::zSide;
 uint64_t Board::zCastle[16];
 uint64_t Board::zEP[8];
 bool Board::zInitialized = false;
+uint64_t Board::cuckooKey[8192];
+Move Board::cuckooMove[8192];
 
 void Board::initZobrist() {
     if (zInitialized) return;
+    Attacks::init();
     std::mt19937_64 rng(0xDEADBEEFCAFEBABEULL);
     for (int p=0;p<13;p++) for (int s=0;s<64;s++) zKeys[p][s]=rng();
+    // Empty squares don't contribute to the key
+    for (int s=0;s<64;s++) zKeys[0][s]=0;
     zSide = rng();
     for (int i=0;i<16;i++) zCastle[i]=rng();
     for (int i=0;i<8;i++) zEP[i]=rng();
+    initCuckoo();
     zInitialized = true;
 }
 
 Board::Board() {
     initZobrist();
-    loadFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    undoStack.reserve(MAX_GAME_PLY);
+    keyHistory.reserve(MAX_GAME_PLY);
+    // Parse the start position once; later boards copy it
+    static const Position startState = [this] { loadFEN(START_FEN); return state; }();
+    state = startState;
+}
+
+Board::Board(const Position& pos) : state(pos) {
+    initZobrist();
+    undoStack.reserve(MAX_GAME_PLY);
+    keyHistory.reserve(MAX_GAME_PLY);
+    state.pliesFromNull = 0; // no history behind it
 }
 
 static int charToPiece(char c) {
@@ -42,62 +62,232 @@ static char pieceToChar(int pc) {
     return s[pc];
 }
 
-void Board::loadFEN(const std::string& fen) {
-    state = BoardState{};
-    history.clear();
-    stateHistory.clear();
-    std::istringstream ss(fen);
-    std::string board, side, castle, ep, hm, fm;
-    ss >> board >> side >> castle >> ep >> hm >> fm;
+// Next space-separated field of a FEN, advancing pos past it
+static std::string_view nextField(std::string_view fen, size_t& pos) {
+    while (pos < fen.size() && (fen[pos]==' ' || fen[pos]=='\t')) pos++;
+    size_t start = pos;
+    while (pos < fen.size() && fen[pos]!=' ' && fen[pos]!='\t') pos++;
+    return fen.substr(start, pos-start);
+}
+
+// Parse a non-negative decimal counter; false if not all digits
+static bool parseCounter(std::string_view f, int& out) {
+    if (f.empty() || f.size() > 6) return false;
+    int v = 0;
+    for (char c : f) {
+        if (c<'0' || c>'9') return false;
+        v = v*10 + (c-'0');
+    }
+    out = v;
+    return true;
+}
+
+// Whether a freshly placed position can be played from: one king and at
+// most 16 pieces per side (pack and SEE rely on 32 in all), the side not
+// to move not in check, no pawns on the back ranks, castling rights only with king and rook on their home
+// squares, and an en passant square only behind an enemy pawn that has
+// just double-stepped over it. Make/unmake trust all of this, so both
+// loadFEN and unpack check it before accepting a state.
+static bool isConsistent(const Position& st) {
+    if (st.pieceCount[makePiece(WHITE,KING)]!=1 || st.pieceCount[makePiece(BLACK,KING)]!=1) return false;
+    if (popcount(st.byColor[WHITE]) > 16 || popcount(st.byColor[BLACK]) > 16) return false;
+    if (st.byType[PAWN] & (RANK_1_BB | RANK_1_BB<<56)) return false;
+
+    // Otherwise the side to move could capture the king
+    Color us = st.sideToMove, them = (us==WHITE)?BLACK:WHITE;
+    Square tks = st.kingSq[them];
+    Bitboard occ = st.byType[NONE];
+    Bitboard checkers = (pawnAttacks(them, tks) & st.byType[PAWN])
+                      | (knightAttacks(tks) & st.byType[KNIGHT])
+                      | (kingAttacks(tks) & st.byType[KING])
+                      | (rookAttacks(tks, occ) & (st.byType[ROOK]|st.byType[QUEEN]))
+                      | (bishopAttacks(tks, occ) & (st.byType[BISHOP]|st.byType[QUEEN]));
+    if (checkers & st.byColor[us]) return false;
+
+    static constexpr Square CASTLE_ROOK[4] = {7, 0, 63, 56};
+    for (int i=0;i<4;i++) {
+        if (!(st.castling & (1<<i))) continue;
+        Color c = i<2 ? WHITE : BLACK;
+        if (st.squares[c==WHITE ? 4 : 60]!=makePiece(c,KING)) return false;
+        if (st.squares[CASTLE_ROOK[i]]!=makePiece(c,ROOK)) return false;
+    }
 
-    // Board
-    int sq = 56; // a8
+    if (st.epSquare!=NO_SQ) {
+        // White to move: target on rank 6, black pawn below it, and the
+        // target and the pawn's start square empty (mirrored for Black)
+        int up = (us==WHITE)?8:-8;
+        Square ep = st.epSquare;
+        if (ep/8 != (us==WHITE ? 5 : 2)) return false;
+        if (st.squares[ep-up]!=makePiece(them,PAWN)) return false;
+        if (st.squares[ep] || st.squares[ep+up]) return false;
+    }
+    return true;
+}
+
+bool Board::loadFEN(std::string_view fen) {
+    // Parse into a fresh state; on malformed input the old one is restored
+    Position saved = state;
+    state = Position{};
+    auto fail = [&] { state = saved; return false; };
+
+    size_t pos = 0;
+    std::string_view board = nextField(fen, pos);
+    std::string_view side = nextField(fen, pos);
+    std::string_view castle = nextField(fen, pos);
+    std::string_view ep = nextField(fen, pos);
+
+    // Board: 8 ranks of 8 squares from a8, at most one king and ten of any
+    // other piece per side (the piece list capacity)
+    int rank = 7, file = 0;
     for (char c : board) {
-        if (c == '/') { sq -= 16; }
-        else if (c >= '1' && c <= '8') { sq += c-'0'; }
-        else { state.squares[sq] = charToPiece(c); sq++; }
-    }
-    state.sideToMove = (side == "w") ? WHITE : BLACK;
-    state.castling = 0;
-    for (char c : castle) {
-        if (c=='K') state.castling|=1;
-        if (c=='Q') state.castling|=2;
-        if (c=='k') state.castling|=4;
-        if (c=='q') state.castling|=8;
-    }
-    if (ep != "-") {
-        int f = ep[0]-'a', r = ep[1]-'1';
-        state.epSquare = r*8+f;
-    }
-    state.halfmove = hm.empty() ? 0 : std::stoi(hm);
-    state.fullmove = fm.empty() ? 1 : std::stoi(fm);
+        if (c == '/') {
+            if (file!=8 || rank==0) return fail();
+            rank--; file = 0;
+        } else if (c >= '1' && c <= '8') {
+            file += c-'0';
+            if (file > 8) return fail();
+        } else {
+            int pc = charToPiece(c);
+            if (!pc || file > 7) return fail();
+            if (state.pieceCount[pc] >= (pieceType(pc)==KING ? 1 : 10)) return fail();
+            putPiece(rank*8+file, pc);
+            file++;
+        }
+    }
+    if (rank!=0 || file!=8) return fail();
+
+    if (side=="w") state.sideToMove = WHITE;
+    else if (side=="b") state.sideToMove = BLACK;
+    else return fail();
+
+    if (castle!="-") {
+        if (castle.empty()) return fail();
+        for (char c : castle) {
+            if (c=='K') state.castling|=1;
+            else if (c=='Q') state.castling|=2;
+            else if (c=='k') state.castling|=4;
+            else if (c=='q') state.castling|=8;
+            else return fail();
+        }
+    }
+
+    if (ep!="-") {
+        if (ep.size()!=2 || ep[0]<'a' || ep[0]>'h' || (ep[1]!='3' && ep[1]!='6')) return fail();
+        state.epSquare = (ep[1]-'1')*8 + (ep[0]-'a');
+    }
+
+    // Clocks are optional (EPD lines carry operations here instead)
+    size_t opsPos = pos;
+    int hm = 0, fm = 1;
+    if (!parseCounter(nextField(fen, pos), hm)) pos = opsPos;
+    else if (!parseCounter(nextField(fen, pos), fm)) fm = 1;
+    state.halfmove = (uint16_t)std::min(hm, 65535);
+    state.fullmove = (uint16_t)std::clamp(fm, 1, 65535);
+    if (!isConsistent(state)) return fail();
+
+    undoStack.clear();
+    keyHistory.clear();
     recomputeZobrist();
+    return true;
 }
 
-std::string Board::toFEN() const {
-    std::string fen;
+int Board::writeFEN(char* out) const {
+    char* p = out;
     for (int r=7;r>=0;r--) {
         int empty=0;
         for (int f=0;f<8;f++) {
             int pc = state.squares[r*8+f];
             if (pc==0) empty++;
-            else { if(empty){fen+=('0'+empty);empty=0;} fen+=pieceToChar(pc); }
+            else { if(empty){*p++=(char)('0'+empty);empty=0;} *p++=pieceToChar(pc); }
         }
-        if (empty) fen+=('0'+empty);
-        if (r>0) fen+='/';
-    }
-    fen += (state.sideToMove==WHITE)?" w ":" b ";
-    std::string cas;
-    if(state.castling&1) cas+='K';
-    if(state.castling&2) cas+='Q';
-    if(state.castling&4) cas+='k';
-    if(state.castling&8) cas+='q';
-    if(cas.empty()) cas="-";
-    fen+=cas+" ";
-    if(state.epSquare==NO_SQ) fen+="-";
-    else { fen+=(char)('a'+state.epSquare%8); fen+=(char)('1'+state.epSquare/8); }
-    fen+=" "+std::to_string(state.halfmove)+" "+std::to_string(state.fullmove);
-    return fen;
+        if (empty) *p++=(char)('0'+empty);
+        if (r>0) *p++='/';
+    }
+    *p++=' ';
+    *p++=(state.sideToMove==WHITE)?'w':'b';
+    *p++=' ';
+    if (!state.castling) *p++='-';
+    if(state.castling&1) *p++='K';
+    if(state.castling&2) *p++='Q';
+    if(state.castling&4) *p++='k';
+    if(state.castling&8) *p++='q';
+    *p++=' ';
+    if(state.epSquare==NO_SQ) *p++='-';
+    else { *p++=(char)('a'+state.epSquare%8); *p++=(char)('1'+state.epSquare/8); }
+    p += snprintf(p, MAX_FEN_LEN-(p-out), " %d %d", state.halfmove, state.fullmove);
+    return (int)(p-out);
+}
+
+std::string Board::toFEN() const {
+    char buf[MAX_FEN_LEN];
+    return std::string(buf, writeFEN(buf));
+}
+
+bool PackedBoard::operator==(const PackedBoard& o) const {
+    return std::memcmp(bytes, o.bytes, sizeof(bytes)) == 0;
+}
+
+PackedBoard Board::pack(const Position& st) {
+    PackedBoard p;
+    Bitboard occ = st.byType[NONE];
+    for (int i=0;i<8;i++) p.bytes[i] = (uint8_t)(occ >> (8*i));
+    for (int i=0; occ; i++) {
+        Square s = popLsb(occ);
+        p.bytes[8 + i/2] |= (uint8_t)(st.squares[s] << (4*(i&1)));
+    }
+    p.bytes[24] = (uint8_t)(st.sideToMove | (st.castling << 1));
+    p.bytes[25] = (st.epSquare==NO_SQ) ? 0xFF : (uint8_t)st.epSquare;
+    int hm = st.halfmove, fm = st.fullmove;
+    p.bytes[26] = (uint8_t)hm; p.bytes[27] = (uint8_t)(hm >> 8);
+    p.bytes[28] = (uint8_t)fm; p.bytes[29] = (uint8_t)(fm >> 8);
+    return p;
+}
+
+bool Board::unpack(const PackedBoard& p) {
+    Position saved = state;
+    state = Position{};
+    auto fail = [&] { state = saved; return false; };
+
+    Bitboard occ = 0;
+    for (int i=0;i<8;i++) occ |= (Bitboard)p.bytes[i] << (8*i);
+    if (popcount(occ) > 32) return fail();
+    for (int i=0; occ; i++) {
+        Square s = popLsb(occ);
+        int pc = (p.bytes[8 + i/2] >> (4*(i&1))) & 15;
+        if (pc<1 || pc>12) return fail();
+        if (state.pieceCount[pc] >= (pieceType(pc)==KING ? 1 : 10)) return fail();
+        putPiece(s, pc);
+    }
+    if (p.bytes[24] >> 5) return fail();
+    state.sideToMove = (Color)(p.bytes[24] & 1);
+    state.castling = p.bytes[24] >> 1;
+    if (p.bytes[25]!=0xFF) {
+        int r = p.bytes[25] / 8;
+        if (p.bytes[25] > 63 || (r!=2 && r!=5)) return fail();
+        state.epSquare = p.bytes[25];
+    }
+    state.halfmove = p.bytes[26] | (p.bytes[27] << 8);
+    state.fullmove = (uint16_t)std::max(1, p.bytes[28] | (p.bytes[29] << 8));
+    if (!isConsistent(state)) return fail();
+
+    undoStack.clear();
+    keyHistory.clear();
+    recomputeZobrist();
+    return true;
+}
+
+void Board::packBatch(const Position* in, PackedBoard* out, size_t n) {
+    for (size_t i=0;i<n;i++) out[i] = pack(in[i]);
+}
+
+size_t Board::unpackBatch(const PackedBoard* in, Position* out, size_t n) {
+    Board b;
+    size_t valid = 0;
+    for (size_t i=0;i<n;i++) {
+        if (b.unpack(in[i])) { out[i] = b.state; valid++; }
+        else out[i] = Position{};
+    }
+    return valid;
 }
 
 void Board::print(bool flipped) const {
@@ -143,16 +333,67 @@ void Board::print(bool flipped) const {
     std::cout << "\n\n";
 }
 
-void Board::setPiece(Square s, int pc) {
-    state.zobrist ^= zKeys[state.squares[s]][s];
+void Board::putPiece(Square s, int pc) {
+    Bitboard b = squareBB(s);
     state.squares[s] = pc;
+    state.byType[pieceType(pc)] |= b;
+    state.byType[NONE] |= b;
+    state.byColor[pieceColor(pc)] |= b;
+    // The n-th piece of a kind toggles key [pc][n]
+    state.materialKey ^= zKeys[pc][state.pieceCount[pc]];
+    state.listIndex[s] = state.pieceCount[pc];
+    state.pieceList[pc][state.pieceCount[pc]++] = s;
+    if (pieceType(pc)==KING) state.kingSq[pieceColor(pc)] = s;
+    if (pieceType(pc)==PAWN||pieceType(pc)==KING) state.pawnKey ^= zKeys[pc][s];
+    state.psqMg += PST::PSQ.mg[pc][s];
+    state.psqEg += PST::PSQ.eg[pc][s];
+    state.phase += PST::PHASE[pieceType(pc)];
+}
+
+void Board::removePiece(Square s) {
+    int pc = state.squares[s];
+    Bitboard b = squareBB(s);
+    state.squares[s] = 0;
+    state.byType[pieceType(pc)] ^= b;
+    state.byType[NONE] ^= b;
+    state.byColor[pieceColor(pc)] ^= b;
+    // Fill the hole with the last entry of the list
+    int last = state.pieceList[pc][--state.pieceCount[pc]];
+    state.listIndex[last] = state.listIndex[s];
+    state.pieceList[pc][state.listIndex[s]] = last;
+    state.materialKey ^= zKeys[pc][state.pieceCount[pc]];
+    if (pieceType(pc)==KING) state.kingSq[pieceColor(pc)] = NO_SQ;
+    if (pieceType(pc)==PAWN||pieceType(pc)==KING) state.pawnKey ^= zKeys[pc][s];
+    state.psqMg -= PST::PSQ.mg[pc][s];
+    state.psqEg -= PST::PSQ.eg[pc][s];
+    state.phase -= PST::PHASE[pieceType(pc)];
+}
+
+void Board::movePiece(Square from, Square to) {
+    int pc = state.squares[from];
+    Bitboard b = squareBB(from) | squareBB(to);
+    state.squares[from] = 0;
+    state.squares[to] = pc;
+    state.byType[pieceType(pc)] ^= b;
+    state.byType[NONE] ^= b;
+    state.byColor[pieceColor(pc)] ^= b;
+    state.listIndex[to] = state.listIndex[from];
+    state.pieceList[pc][state.listIndex[to]] = to;
+    if (pieceType(pc)==KING) state.kingSq[pieceColor(pc)] = to;
+    if (pieceType(pc)==PAWN||pieceType(pc)==KING) state.pawnKey ^= zKeys[pc][from] ^ zKeys[pc][to];
+    state.psqMg += PST::PSQ.mg[pc][to] - PST::PSQ.mg[pc][from];
+    state.psqEg += PST::PSQ.eg[pc][to] - PST::PSQ.eg[pc][from];
+}
+
+void Board::setPiece(Square s, int pc) {
+    if (state.squares[s]) clearPiece(s);
+    putPiece(s, pc);
     state.zobrist ^= zKeys[pc][s];
 }
 
 void Board::clearPiece(Square s) {
     state.zobrist ^= zKeys[state.squares[s]][s];
-    state.squares[s] = 0;
-    state.zobrist ^= zKeys[0][s];
+    removePiece(s);
 }
 
 void Board::recomputeZobrist() {
@@ -164,99 +405,346 @@ void Board::recomputeZobrist() {
 }
 
 bool Board::isSquareAttacked(Square s, Color byColor) const {
-    // Check if square s is attacked by byColor
-    // King attacks
-    int koff[] = {-9,-8,-7,-1,1,7,8,9};
-    for (int o : koff) {
-        int t = s+o;
-        if (t<0||t>63) continue;
-        if (abs((t%8)-(s%8))>1) continue;
-        if (abs((t/8)-(s/8))>1) continue;
-        int pc = state.squares[t];
-        if (pc && pieceColor(pc)==byColor && pieceType(pc)==KING) return true;
-    }
-    // Knight
-    int noff[] = {-17,-15,-10,-6,6,10,15,17};
-    for (int o : noff) {
-        int t = s+o;
-        if (t<0||t>63) continue;
-        int df = abs((t%8)-(s%8));
-        if (df!=1&&df!=2) continue;
-        int pc = state.squares[t];
-        if (pc && pieceColor(pc)==byColor && pieceType(pc)==KNIGHT) return true;
-    }
-    // Pawn attacks
-    if (byColor==WHITE) {
-        int t1=s-7, t2=s-9;
-        if (t1>=0 && t1<64 && abs((t1%8)-(s%8))==1) {
-            if (state.squares[t1]==makePiece(WHITE,PAWN)) return true;
-        }
-        if (t2>=0 && t2<64 && abs((t2%8)-(s%8))==1) {
-            if (state.squares[t2]==makePiece(WHITE,PAWN)) return true;
-        }
-    } else {
-        int t1=s+7, t2=s+9;
-        if (t1>=0 && t1<64 && abs((t1%8)-(s%8))==1) {
-            if (state.squares[t1]==makePiece(BLACK,PAWN)) return true;
-        }
-        if (t2>=0 && t2<64 && abs((t2%8)-(s%8))==1) {
-            if (state.squares[t2]==makePiece(BLACK,PAWN)) return true;
-        }
+    return attackersTo(s, state.byType[NONE]) & state.byColor[byColor];
+}
+
+// Rook from/to squares for a castling move, given the king's destination
+static void castlingRookSquares(Square kingTo, Square& rf, Square& rt) {
+    switch (kingTo) {
+        case 6:  rf = 7;  rt = 5;  break; // White kingside
+        case 2:  rf = 0;  rt = 3;  break; // White queenside
+        case 62: rf = 63; rt = 61; break; // Black kingside
+        default: rf = 56; rt = 59; break; // Black queenside
     }
-    // Sliding pieces
-    // Rook/Queen (horizontal/vertical)
-    int rdirs[] = {1,-1,8,-8};
-    for (int d : rdirs) {
-        int t = s+d;
-        while (t>=0&&t<64) {
-            if (d==1&&t%8==0) break;
-            if (d==-1&&t%8==7) break;
-            int pc = state.squares[t];
-            if (pc) {
-                if (pieceColor(pc)==byColor && (pieceType(pc)==ROOK||pieceType(pc)==QUEEN)) return true;
-                break;
+}
+
+// Every reversible move of a non-pawn piece, hashed by its Zobrist delta
+// into two slots (cuckoo hashing: a displaced entry moves to its other slot)
+void Board::initCuckoo() {
+    for (int i=0;i<8192;i++) { cuckooKey[i]=0; cuckooMove[i]=Move(); }
+    for (int pc=1; pc<=12; pc++) {
+        Piece pt = pieceType(pc);
+        if (pt==PAWN) continue;
+        for (Square s1=0; s1<64; s1++) {
+            Bitboard targets = pt==KNIGHT ? knightAttacks(s1)
+                             : pt==BISHOP ? bishopAttacks(s1, 0)
+                             : pt==ROOK   ? rookAttacks(s1, 0)
+                             : pt==QUEEN  ? bishopAttacks(s1, 0) | rookAttacks(s1, 0)
+                             : kingAttacks(s1);
+            for (Square s2=s1+1; s2<64; s2++) {
+                if (!(targets & squareBB(s2))) continue;
+                Move m(s1, s2);
+                uint64_t key = zKeys[pc][s1] ^ zKeys[pc][s2] ^ zSide;
+                int j = key & 8191;
+                while (true) {
+                    std::swap(cuckooKey[j], key);
+                    std::swap(cuckooMove[j], m);
+                    if (m.isNull()) break; // empty slot
+                    j = (j == (int)(key & 8191)) ? (key>>16) & 8191 : key & 8191;
+                }
             }
-            t+=d;
         }
     }
-    // Bishop/Queen (diagonal)
-    int bdirs[] = {9,-9,7,-7};
-    for (int d : bdirs) {
-        int t = s+d;
-        while (t>=0&&t<64) {
-            int tf=t%8, sf=s%8;
-            if (abs(tf-sf)!=abs((t/8)-(s/8))) break; // off board diagonally
-            int pc = state.squares[t];
-            if (pc) {
-                if (pieceColor(pc)==byColor && (pieceType(pc)==BISHOP||pieceType(pc)==QUEEN)) return true;
-                break;
+}
+
+Bitboard Board::attackersTo(Square s, Bitboard occ) const {
+    return (pawnAttacks(BLACK, s) & state.byColor[WHITE] & state.byType[PAWN])
+         | (pawnAttacks(WHITE, s) & state.byColor[BLACK] & state.byType[PAWN])
+         | (knightAttacks(s) & state.byType[KNIGHT])
+         | (kingAttacks(s) & state.byType[KING])
+         | (rookAttacks(s, occ) & (state.byType[ROOK]|state.byType[QUEEN]))
+         | (bishopAttacks(s, occ) & (state.byType[BISHOP]|state.byType[QUEEN]));
+}
+
+bool Board::isSquareAttacked(Square s, Color byColor, Bitboard occ) const {
+    return attackersTo(s, occ) & state.byColor[byColor] & occ;
+}
+
+// Pieces of blockerSide that are the only piece between square ks and a
+// slider of sliderSide aimed at it
+static Bitboard rayBlockers(const Position& st, Square ks, Color sliderSide, Color blockerSide) {
+    Bitboard blockers = 0;
+    Bitboard snipers = ((rookAttacks(ks, 0) & (st.byType[ROOK]|st.byType[QUEEN]))
+                      | (bishopAttacks(ks, 0) & (st.byType[BISHOP]|st.byType[QUEEN])))
+                     & st.byColor[sliderSide];
+    while (snipers) {
+        Square s = popLsb(snipers);
+        Bitboard between = betweenBB(ks, s) & st.byType[NONE];
+        if (between && !(between & (between-1)) && (between & st.byColor[blockerSide]))
+            blockers |= between;
+    }
+    return blockers;
+}
+
+CheckInfo Board::checkInfo() const {
+    CheckInfo ci;
+    Color us = state.sideToMove, them = (us==WHITE)?BLACK:WHITE;
+    Square ks = state.kingSq[us];
+    ci.kingSq = ks;
+    if (ks==NO_SQ) return ci;
+
+    ci.checkers = attackersTo(ks, state.byType[NONE]) & state.byColor[them];
+    ci.pinned = rayBlockers(state, ks, them, us);
+
+    // Single check: capture the checker or block its ray
+    if (ci.checkers)
+        ci.evasionMask = (ci.checkers & (ci.checkers-1)) ? 0 : ci.checkers | betweenBB(ks, lsb(ci.checkers));
+
+    // Checks against the enemy king: squares each piece type would check
+    // from, and our pieces whose departure uncovers one of our sliders
+    Square tks = state.kingSq[them];
+    ci.theirKingSq = tks;
+    if (tks!=NO_SQ) {
+        Bitboard occ = state.byType[NONE];
+        ci.checkSquares[PAWN] = pawnAttacks(them, tks);
+        ci.checkSquares[KNIGHT] = knightAttacks(tks);
+        ci.checkSquares[BISHOP] = bishopAttacks(tks, occ);
+        ci.checkSquares[ROOK] = rookAttacks(tks, occ);
+        ci.checkSquares[QUEEN] = ci.checkSquares[BISHOP] | ci.checkSquares[ROOK];
+        ci.discoverers = rayBlockers(state, tks, us, us);
+    }
+    return ci;
+}
+
+bool Board::givesCheck(Move m, const CheckInfo& ci) const {
+    Square tks = ci.theirKingSq;
+    if (tks==NO_SQ) return false;
+    Square from = m.from(), to = m.to();
+    Color us = state.sideToMove;
+    int flags = m.flags();
+    Piece pt = pieceType(state.squares[from]);
+
+    // Direct check
+    if (flags!=FLAG_PROMO && (ci.checkSquares[pt] & squareBB(to))) return true;
+
+    // Discovered check: a blocker leaving the line to the enemy king
+    if ((ci.discoverers & squareBB(from)) && !(lineBB(tks, from) & squareBB(to))) return true;
+
+    Bitboard occ = state.byType[NONE] ^ squareBB(from);
+    Bitboard ours = state.byColor[us];
+    switch (flags) {
+        case FLAG_PROMO: {
+            // The new piece attacks from 'to' with the pawn gone from 'from'
+            occ |= squareBB(to);
+            switch (m.promo()) {
+                case PROMO_N: return knightAttacks(to) & squareBB(tks);
+                case PROMO_B: return bishopAttacks(to, occ) & squareBB(tks);
+                case PROMO_R: return rookAttacks(to, occ) & squareBB(tks);
+                default: return (bishopAttacks(to, occ) | rookAttacks(to, occ)) & squareBB(tks);
             }
-            t+=d;
         }
+        case FLAG_EP: {
+            // Removing the captured pawn may uncover a slider as well
+            Square capSq = to + (us==WHITE?-8:8);
+            occ = (occ ^ squareBB(capSq)) | squareBB(to);
+            ours = (ours ^ squareBB(from)) | squareBB(to);
+            return (rookAttacks(tks, occ) & ours & (state.byType[ROOK]|state.byType[QUEEN]))
+                || (bishopAttacks(tks, occ) & ours & (state.byType[BISHOP]|state.byType[QUEEN]));
+        }
+        case FLAG_CASTLE: {
+            // Only the rook can give check
+            Square rf, rt;
+            castlingRookSquares(to, rf, rt);
+            occ = (occ ^ squareBB(rf)) | squareBB(to) | squareBB(rt);
+            return rookAttacks(rt, occ) & squareBB(tks);
+        }
+        default:
+            return false;
     }
+}
+
+bool Board::isPseudoLegal(Move m) const {
+    if (m.isNull()) return false;
+    Color us = state.sideToMove, them = (us==WHITE)?BLACK:WHITE;
+    Square from = m.from(), to = m.to();
+    int pc = state.squares[from], flags = m.flags();
+    if (!pc || pieceColor(pc)!=us) return false;
+    if (state.byColor[us] & squareBB(to)) return false;
+    if (flags!=FLAG_PROMO && m.promo()) return false;
+
+    if (flags==FLAG_CASTLE) {
+        // Same tests as the generator: right held, path empty, king's
+        // squares not attacked
+        int shift = (us==WHITE)?0:56;
+        if (from!=4+shift || pieceType(pc)!=KING) return false;
+        bool kingSide = (to==6+shift);
+        if (!kingSide && to!=2+shift) return false;
+        int right = kingSide ? ((us==WHITE)?1:4) : ((us==WHITE)?2:8);
+        Bitboard path = (kingSide ? 0x60ULL : 0x0EULL) << shift;
+        Bitboard safe = (kingSide ? 0x70ULL : 0x1CULL) << shift;
+        return (state.castling & right) && !(state.byType[NONE] & path) && !anyAttacked(safe, them);
+    }
+
+    if (pieceType(pc)!=PAWN) return flags==FLAG_NORMAL && (pieceAttacks(from, state.byType[NONE]) & squareBB(to));
+
+    if (flags==FLAG_EP) return to==state.epSquare && (pawnAttacks(us, from) & squareBB(to));
+    // Promotions exactly when reaching the last rank
+    bool lastRank = (us==WHITE) ? to>=56 : to<8;
+    if (lastRank != (flags==FLAG_PROMO)) return false;
+    if (pawnAttacks(us, from) & squareBB(to)) return state.byColor[them] & squareBB(to);
+    int up = (us==WHITE)?8:-8;
+    if (to==from+up) return !(state.byType[NONE] & squareBB(to));
+    bool startRank = (us==WHITE) ? (from>=8 && from<16) : (from>=48 && from<56);
+    return startRank && to==from+2*up && !(state.byType[NONE] & (squareBB(to)|squareBB(from+up)));
+}
+
+bool Board::isLegal(Move m, const CheckInfo& ci) const {
+    Square from = m.from(), to = m.to();
+    Color us = state.sideToMove, them = (us==WHITE)?BLACK:WHITE;
+    int flags = m.flags();
+
+    if (flags==FLAG_CASTLE) return true;
+
+    if (from==ci.kingSq) {
+        // King may not step onto an attacked square, including squares
+        // behind it on a checking slider's ray
+        return !isSquareAttacked(to, them, state.byType[NONE] ^ squareBB(from));
+    }
+
+    if (flags==FLAG_EP) {
+        // Removes two pieces from one rank, so test the resulting position
+        Square capSq = to + (us==WHITE?-8:8);
+        Bitboard occ = (state.byType[NONE] ^ squareBB(from) ^ squareBB(capSq)) | squareBB(to);
+        return !isSquareAttacked(ci.kingSq, them, occ);
+    }
+
+    if (!(ci.evasionMask & squareBB(to))) return false;
+    if ((ci.pinned & squareBB(from)) && !(lineBB(ci.kingSq, from) & squareBB(to))) return false;
+    return true;
+}
+
+// Piece values for exchange evaluation, indexed by piece type
+static constexpr int SEE_VALUE[7] = {0, Eval::PAWN_VAL, Eval::KNIGHT_VAL, Eval::BISHOP_VAL,
+                                     Eval::ROOK_VAL, Eval::QUEEN_VAL, Eval::KING_VAL};
+
+int Board::see(Move m) const {
+    if (m.flags()==FLAG_CASTLE) return 0;
+    Square from = m.from(), to = m.to();
+    Color side = state.sideToMove;
+    Bitboard occ = state.byType[NONE];
+
+    // gain[d]: score for the side making capture d if the exchange stops there
+    int gain[32];
+    int d = 0;
+    int attackerVal = SEE_VALUE[pieceType(state.squares[from])];
+    gain[0] = SEE_VALUE[pieceType(state.squares[to])];
+    if (m.flags()==FLAG_EP) {
+        gain[0] = SEE_VALUE[PAWN];
+        occ ^= squareBB(to + (side==WHITE?-8:8));
+    } else if (m.flags()==FLAG_PROMO) {
+        attackerVal = SEE_VALUE[KNIGHT + m.promo()];
+        gain[0] += attackerVal - SEE_VALUE[PAWN];
+    }
+
+    Bitboard attackers = attackersTo(to, occ);
+    Bitboard fromBB = squareBB(from);
+    Bitboard diag = state.byType[BISHOP] | state.byType[QUEEN];
+    Bitboard orth = state.byType[ROOK] | state.byType[QUEEN];
+    while (true) {
+        d++;
+        gain[d] = attackerVal - gain[d-1];
+        if (std::max(-gain[d-1], gain[d]) < 0) break; // neither side can improve
+        // Lift the capturer off the board: sliders behind it join in (x-rays)
+        occ ^= fromBB;
+        attackers = (attackers | (bishopAttacks(to, occ) & diag) | (rookAttacks(to, occ) & orth)) & occ;
+
+        side = (side==WHITE)?BLACK:WHITE;
+        Bitboard mine = attackers & state.byColor[side];
+        if (!mine) break;
+        // Least valuable attacker recaptures next
+        int pt = PAWN;
+        while (!(mine & state.byType[pt])) pt++;
+        // The king may only recapture onto an undefended square
+        if (pt==KING && (attackers & ~mine)) break;
+        fromBB = squareBB(lsb(mine & state.byType[pt]));
+        attackerVal = SEE_VALUE[pt];
+    }
+    while (--d) gain[d-1] = -std::max(-gain[d-1], gain[d]);
+    return gain[0];
+}
+
+bool Board::seeGE(Move m, int threshold) const {
+    if (m.flags()==FLAG_CASTLE || m.flags()==FLAG_PROMO) return see(m) >= threshold;
+    int captured = (m.flags()==FLAG_EP) ? SEE_VALUE[PAWN] : SEE_VALUE[pieceType(state.squares[m.to()])];
+    // Can't win more than the captured piece, can't lose more than the capturer
+    if (captured < threshold) return false;
+    if (captured - SEE_VALUE[pieceType(state.squares[m.from()])] >= threshold) return true;
+    return see(m) >= threshold;
+}
+
+Bitboard Board::pieceAttacks(Square s, Bitboard occ) const {
+    int pc = state.squares[s];
+    switch (pieceType(pc)) {
+        case PAWN:   return pawnAttacks(pieceColor(pc), s);
+        case KNIGHT: return knightAttacks(s);
+        case BISHOP: return bishopAttacks(s, occ);
+        case ROOK:   return rookAttacks(s, occ);
+        case QUEEN:  return queenAttacks(s, occ);
+        case KING:   return kingAttacks(s);
+        default:     return 0;
+    }
+}
+
+bool Board::anyAttacked(Bitboard squares, Color byColor) const {
+    while (squares) if (attackersTo(popLsb(squares)) & state.byColor[byColor]) return true;
     return false;
 }
 
 bool Board::isInCheck(Color c) const {
-    // Find king
-    int kpc = makePiece(c, KING);
-    Square ks = -1;
-    for (int s=0;s<64;s++) if (state.squares[s]==kpc) { ks=s; break; }
-    if (ks==-1) return false;
+    Square ks = state.kingSq[c];
+    if (ks==NO_SQ) return false;
     return isSquareAttacked(ks, c==WHITE?BLACK:WHITE);
 }
 
 bool Board::makeMove(Move m) {
-    stateHistory.push_back(state);
-    
+    doMove(m);
+
+    // Check if move leaves us in check (illegal)
+    Color mover = (state.sideToMove==WHITE)?BLACK:WHITE;
+    if (isInCheck(mover)) {
+        unmakeMove();
+        return false;
+    }
+    return true;
+}
+
+// Castling rights kept when a move touches each square: king and rook
+// home squares clear the matching rights
+static constexpr std::array<uint8_t,64> CASTLE_KEEP = [] {
+    std::array<uint8_t,64> k{};
+    for (int s=0;s<64;s++) k[s] = 15;
+    k[4] = 15 & ~3;  k[60] = 15 & ~12; // kings
+    k[7] = 15 & ~1;  k[0] = 15 & ~2;   // white rooks
+    k[63] = 15 & ~4; k[56] = 15 & ~8;  // black rooks
+    return k;
+}();
+
+void Board::doMove(Move m) {
+    if (state.sideToMove==WHITE) doMoveImpl<WHITE>(m);
+    else doMoveImpl<BLACK>(m);
+}
+
+void Board::unmakeMove() {
+    if (undoStack.empty()) return;
+    // The side that made the move is the one not to move now
+    if (state.sideToMove==BLACK) unmakeMoveImpl<WHITE>();
+    else unmakeMoveImpl<BLACK>();
+}
+
+template<Color Us>
+void Board::doMoveImpl(Move m) {
+    constexpr Color Them = (Us==WHITE)?BLACK:WHITE;
+    constexpr int Down = (Us==WHITE)?-8:8;
     Square from = m.from(), to = m.to();
     int flags = m.flags();
-    
-    state.prevCastling = state.castling;
-    state.prevEP = state.epSquare;
-    state.prevHalfmove = state.halfmove;
-    state.capturedPiece = 0;
-    state.lastMove = m;
+
+    UndoInfo u;
+    u.move = m;
+    u.castling = (uint8_t)state.castling;
+    u.epSquare = (int8_t)state.epSquare;
+    u.halfmove = (uint16_t)state.halfmove;
+    u.pliesFromNull = (uint16_t)state.pliesFromNull;
+    keyHistory.push_back(state.zobrist);
 
     // Update zobrist for old ep/castle
     if (state.epSquare!=NO_SQ) state.zobrist ^= zEP[state.epSquare%8];
@@ -264,147 +752,224 @@ bool Board::makeMove(Move m) {
     
     int pc = state.squares[from];
     int cap = state.squares[to];
-    state.capturedPiece = cap;
 
     // Halfmove
-    if (cap || pieceType(pc)==PAWN) state.halfmove=0;
+    if (cap || pc==makePiece(Us,PAWN)) state.halfmove=0;
     else state.halfmove++;
+    state.pliesFromNull++;
 
     state.epSquare = NO_SQ;
 
     if (flags==FLAG_EP) {
         // En passant
-        Square capSq = to + (state.sideToMove==WHITE?-8:8);
-        state.capturedPiece = state.squares[capSq];
-        state.zobrist ^= zKeys[state.squares[capSq]][capSq];
-        state.squares[capSq] = 0;
-        state.zobrist ^= zKeys[0][capSq];
+        Square capSq = to + Down;
+        cap = makePiece(Them,PAWN);
+        clearPiece(capSq);
     } else if (flags==FLAG_CASTLE) {
         // Move rook too
-        int rf, rt;
-        if (to==6||to==62) { // Kingside
-            rf = (state.sideToMove==WHITE)?7:63;
-            rt = (state.sideToMove==WHITE)?5:61;
-        } else { // Queenside
-            rf = (state.sideToMove==WHITE)?0:56;
-            rt = (state.sideToMove==WHITE)?3:59;
-        }
-        int rpc = state.squares[rf];
-        state.zobrist ^= zKeys[rpc][rf];
-        state.squares[rf] = 0;
-        state.zobrist ^= zKeys[0][rf];
-        state.zobrist ^= zKeys[0][rt];
-        state.squares[rt] = rpc;
-        state.zobrist ^= zKeys[rpc][rt];
+        Square rf, rt;
+        castlingRookSquares(to, rf, rt);
+        constexpr int rook = makePiece(Us,ROOK);
+        state.zobrist ^= zKeys[rook][rf] ^ zKeys[rook][rt];
+        movePiece(rf, rt);
+    } else if (cap) {
+        clearPiece(to);
     }
+    u.captured = (uint8_t)cap;
 
     // Move piece
-    state.zobrist ^= zKeys[pc][from];
-    state.squares[from] = 0;
-    state.zobrist ^= zKeys[0][from];
-    
+    state.zobrist ^= zKeys[pc][from] ^ zKeys[pc][to];
+    movePiece(from, to);
+
     if (flags==FLAG_PROMO) {
-        int promoPiece[] = {KNIGHT,BISHOP,ROOK,QUEEN};
-        int npc = makePiece(state.sideToMove, (Piece)promoPiece[m.promo()]);
-        state.zobrist ^= zKeys[cap][to];
-        state.squares[to] = npc;
-        state.zobrist ^= zKeys[npc][to];
-    } else {
-        state.zobrist ^= zKeys[cap][to];
-        state.squares[to] = pc;
-        state.zobrist ^= zKeys[pc][to];
+        setPiece(to, makePiece(Us, (Piece)(KNIGHT + m.promo())));
     }
 
     // En passant square
-    if (pieceType(pc)==PAWN && abs(to-from)==16) {
-        state.epSquare = (from+to)/2;
+    if (pc==makePiece(Us,PAWN) && (to^from)==16) {
+        state.epSquare = to + Down;
         state.zobrist ^= zEP[state.epSquare%8];
     }
 
-    // Update castling rights
-    // Remove castling rights if king or rook moves
-    if (from==4||to==4) state.castling&=~3; // white king
-    if (from==60||to==60) state.castling&=~12; // black king
-    if (from==0||to==0) state.castling&=~2; // white QR
-    if (from==7||to==7) state.castling&=~1; // white KR
-    if (from==56||to==56) state.castling&=~8; // black QR
-    if (from==63||to==63) state.castling&=~4; // black KR
-    
+    // Moving from or onto a king/rook home square drops castling rights
+    state.castling &= CASTLE_KEEP[from] & CASTLE_KEEP[to];
     state.zobrist ^= zCastle[state.castling];
 
     // Side to move
-    state.sideToMove = (state.sideToMove==WHITE)?BLACK:WHITE;
+    state.sideToMove = Them;
     state.zobrist ^= zSide;
-    if (state.sideToMove==WHITE) state.fullmove++;
+    if (Us==BLACK) state.fullmove++;
 
-    // Check if move leaves us in check (illegal)
-    Color mover = (state.sideToMove==WHITE)?BLACK:WHITE;
-    if (isInCheck(mover)) {
-        unmakeMove();
-        return false;
+    undoStack.push_back(u);
+}
+
+template<Color Us>
+void Board::unmakeMoveImpl() {
+    constexpr int Down = (Us==WHITE)?-8:8;
+    const UndoInfo& u = undoStack.back();
+    Move m = u.move;
+    Square from = m.from(), to = m.to();
+    int flags = m.flags();
+
+    state.sideToMove = Us;
+    if (Us==BLACK) state.fullmove--;
+
+    if (flags==FLAG_PROMO) {
+        removePiece(to);
+        putPiece(to, makePiece(Us, PAWN));
     }
+    movePiece(to, from);
 
-    history.push_back(m);
-    return true;
+    if (flags==FLAG_EP) {
+        putPiece(to + Down, u.captured);
+    } else if (flags==FLAG_CASTLE) {
+        Square rf, rt;
+        castlingRookSquares(to, rf, rt);
+        movePiece(rt, rf);
+    } else if (u.captured) {
+        putPiece(to, u.captured);
+    }
+
+    state.castling = u.castling;
+    state.epSquare = u.epSquare;
+    state.halfmove = u.halfmove;
+    state.pliesFromNull = u.pliesFromNull;
+    state.zobrist = keyHistory.back();
+    keyHistory.pop_back();
+    undoStack.pop_back();
 }
 
-void Board::unmakeMove() {
-    if (stateHistory.empty()) return;
-    // pop history
-    if (!history.empty()) history.pop_back();
-    state = stateHistory.back();
-    stateHistory.pop_back();
+void Board::makeNullMove() {
+    UndoInfo u;
+    u.castling = (uint8_t)state.castling;
+    u.epSquare = (int8_t)state.epSquare;
+    u.halfmove = (uint16_t)state.halfmove;
+    u.pliesFromNull = (uint16_t)state.pliesFromNull;
+    undoStack.push_back(u);
+    keyHistory.push_back(state.zobrist);
+
+    if (state.epSquare!=NO_SQ) {
+        state.zobrist ^= zEP[state.epSquare%8];
+        state.epSquare = NO_SQ;
+    }
+    state.halfmove++;
+    state.pliesFromNull = 0;
+    state.sideToMove = (state.sideToMove==WHITE)?BLACK:WHITE;
+    state.zobrist ^= zSide;
+}
+
+void Board::unmakeNullMove() {
+    const UndoInfo& u = undoStack.back();
+    state.sideToMove = (state.sideToMove==WHITE)?BLACK:WHITE;
+    state.epSquare = u.epSquare;
+    state.halfmove = u.halfmove;
+    state.pliesFromNull = u.pliesFromNull;
+    state.zobrist = keyHistory.back();
+    keyHistory.pop_back();
+    undoStack.pop_back();
 }
 
 int Board::repetitionCount() const {
+    // Only positions since the last irreversible move (and not before a
+    // null move) can repeat, and only with the same side to move: every
+    // second key, starting four plies back
+    int end = std::min(state.halfmove, state.pliesFromNull);
+    if (end < 4) return 1;
     int cnt = 1;
     uint64_t z = state.zobrist;
-    for (int i=(int)stateHistory.size()-1;i>=0;i--) {
-        if (stateHistory[i].zobrist==z) cnt++;
-        if (stateHistory[i].halfmove==0 && i!=(int)stateHistory.size()-1) break;
-    }
+    const uint64_t* key = keyHistory.data() + keyHistory.size();
+    for (int i=4; i<=end; i+=2)
+        if (key[-i]==z) cnt++;
     return cnt;
 }
 
-bool Board::isDraw() const {
-    if (state.halfmove>=100) return true;
-    if (repetitionCount()>=3) return true;
-    // Insufficient material
-    int wn=countPiece(WHITE,KNIGHT),bn=countPiece(BLACK,KNIGHT);
-    int wb=countPiece(WHITE,BISHOP),bb=countPiece(BLACK,BISHOP);
-    int wr=countPiece(WHITE,ROOK),br=countPiece(BLACK,ROOK);
-    int wq=countPiece(WHITE,QUEEN),bq=countPiece(BLACK,QUEEN);
-    int wp=countPiece(WHITE,PAWN),bp=countPiece(BLACK,PAWN);
-    if (wp||bp||wr||br||wq||bq) return false;
-    if (wn==0&&wb==0&&bn==0&&bb==0) return true; // K vs K
-    if (wb==1&&wn==0&&bb==0&&bn==0&&wp==0&&bp==0) return true; // K+B vs K
-    if (bb==1&&bn==0&&wb==0&&wn==0&&wp==0&&bp==0) return true;
-    if (wn==1&&wb==0&&bb==0&&bn==0&&wp==0&&bp==0) return true;
-    if (bn==1&&bb==0&&wb==0&&wn==0&&wp==0&&bp==0) return true;
+bool Board::hasUpcomingRepetition(int ply) const {
+    int end = std::min(state.halfmove, state.pliesFromNull);
+    if (end < 3) return false;
+
+    // key[-i] is the position i plies ago. 'other' accumulates the changes
+    // made by the opponent's moves: once they cancel out, the difference
+    // to that position is our own moves, and if that equals a single
+    // reversible move the position can be reached again.
+    const uint64_t* key = keyHistory.data() + keyHistory.size();
+    uint64_t original = state.zobrist;
+    uint64_t other = original ^ key[-1] ^ zSide;
+    for (int i=3; i<=end; i+=2) {
+        other ^= key[-(i-1)] ^ key[-i] ^ zSide;
+        if (other) continue;
+        // Only cycles inside the search tree count
+        if (ply <= i) break;
+
+        uint64_t moveKey = original ^ key[-i];
+        int j = moveKey & 8191;
+        if (cuckooKey[j]!=moveKey) j = (moveKey>>16) & 8191;
+        if (cuckooKey[j]!=moveKey) continue;
+
+        // The move must not be blocked
+        Move m = cuckooMove[j];
+        if (!(betweenBB(m.from(), m.to()) & state.byType[NONE])) return true;
+    }
     return false;
 }
 
-int Board::countPiece(Color c, Piece p) const {
-    int pc = makePiece(c,p);
-    int cnt=0;
-    for (int s=0;s<64;s++) if (state.squares[s]==pc) cnt++;
-    return cnt;
+bool Board::isDraw() const {
+    if (state.halfmove>=100) return true;
+    // Insufficient material: K vs K, or a single minor piece left
+    if (!(state.byType[PAWN]|state.byType[ROOK]|state.byType[QUEEN]) &&
+        popcount(state.byType[KNIGHT]|state.byType[BISHOP]) <= 1) return true;
+    return repetitionCount()>=3;
 }
 
-Bitboard Board::pieceBB(Color c, Piece p) const {
-    int pc = makePiece(c,p);
-    Bitboard bb=0;
-    for (int s=0;s<64;s++) if (state.squares[s]==pc) bb|=(1ULL<<s);
-    return bb;
+// Stops at the first legal move. King moves go first: they are the only
+// replies to a double check and the likeliest escape from a single one.
+// Castling is never needed: when it is legal, so is the king's step
+// towards the rook.
+bool Board::hasLegalMove() const {
+    Color us = state.sideToMove, them = (us==WHITE)?BLACK:WHITE;
+    CheckInfo ci = checkInfo();
+    Bitboard own = state.byColor[us], occ = state.byType[NONE];
+    Square ks = ci.kingSq;
+
+    if (ks!=NO_SQ) {
+        for (Bitboard b = kingAttacks(ks) & ~own; b; )
+            if (!isSquareAttacked(popLsb(b), them, occ ^ squareBB(ks))) return true;
+    }
+
+    // Everything else must capture or block a checker (evasionMask is empty
+    // in double check), and pinned pieces must stay on the pin line
+    Bitboard target = ci.evasionMask & ~own;
+    if (!target) return false;
+    auto reachable = [&](Square s, Bitboard to) {
+        if (ci.pinned & squareBB(s)) to &= lineBB(ks, s);
+        return to != 0;
+    };
+
+    for (Bitboard pcs = own & ~(state.byType[PAWN]|state.byType[KING]); pcs; ) {
+        Square s = popLsb(pcs);
+        if (reachable(s, pieceAttacks(s, occ) & target)) return true;
+    }
+
+    auto forward = [us](Bitboard b) { return us==WHITE ? b<<8 : b>>8; };
+    Bitboard thirdRank = (us==WHITE) ? RANK_1_BB<<16 : RANK_1_BB<<40;
+    for (Bitboard pawns = own & state.byType[PAWN]; pawns; ) {
+        Square s = popLsb(pawns);
+        Bitboard push = forward(squareBB(s)) & ~occ;
+        Bitboard to = push | (forward(push & thirdRank) & ~occ)
+                    | (pawnAttacks(us, s) & state.byColor[them]);
+        if (reachable(s, to & target)) return true;
+    }
+
+    if (state.epSquare!=NO_SQ) {
+        for (Bitboard b = own & state.byType[PAWN] & pawnAttacks(them, state.epSquare); b; )
+            if (isLegal(Move(popLsb(b), state.epSquare, FLAG_EP), ci)) return true;
+    }
+    return false;
 }
 
-bool Board::isCheckmate() {
-    if (!isInCheck(state.sideToMove)) return false;
-    // Need movegen - will use from CLI
-    return false; // placeholder, CLI handles this
+bool Board::isCheckmate() const {
+    return isInCheck(state.sideToMove) && !hasLegalMove();
 }
 
-bool Board::isStalemate() {
-    if (isInCheck(state.sideToMove)) return false;
-    return false; // placeholder
+bool Board::isStalemate() const {
+    return !isInCheck(state.sideToMove) && !hasLegalMove();
 }
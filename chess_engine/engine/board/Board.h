@@ -1,9 +1,11 @@
 #pragma once
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <array>
 #include <optional>
+#include <type_traits>
 
 // Piece types
 enum Piece { NONE=0, PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING };
@@ -15,10 +17,17 @@ using Bitboard = uint64_t;
 
 constexpr Square NO_SQ = -1;
 
+// Bitboard helpers (bit i set = square i occupied)
+constexpr Bitboard squareBB(Square s) { return 1ULL << s; }
+inline int popcount(Bitboard b) { return __builtin_popcountll(b); }
+inline Square lsb(Bitboard b) { return __builtin_ctzll(b); }
+inline Square msb(Bitboard b) { return 63 ^ __builtin_clzll(b); }
+inline Square popLsb(Bitboard& b) { Square s = lsb(b); b &= b - 1; return s; }
+
 // Piece encoding: 0=none, 1-6 white P/N/B/R/Q/K, 7-12 black P/N/B/R/Q/K
-inline int makePiece(Color c, Piece p) { return (int)p + (c == BLACK ? 6 : 0); }
-inline Color pieceColor(int pc) { return (pc >= 7) ? BLACK : WHITE; }
-inline Piece pieceType(int pc) { return (Piece)(pc > 6 ? pc - 6 : pc); }
+constexpr int makePiece(Color c, Piece p) { return (int)p + (c == BLACK ? 6 : 0); }
+constexpr Color pieceColor(int pc) { return (pc >= 7) ? BLACK : WHITE; }
+constexpr Piece pieceType(int pc) { return (Piece)(pc > 6 ? pc - 6 : pc); }
 
 // Move encoding: 16 bits
 // bits 0-5: from, 6-11: to, 12-13: promo (0=none,1=N,2=B,3=R,4=Q), 14-15: flags
@@ -38,6 +47,20 @@ struct Move {
     bool operator!=(const Move& o) const { return data != o.data; }
 };
 
+// A generated move with the piece it moves and the piece it captures (a
+// pawn for en passant, 0 for none), filled in by the generator, plus the
+// ordering score the search gives it. Move stays the compact form for the
+// TT and PV; ordering never has to look back at the board.
+struct ScoredMove {
+    Move move;
+    uint8_t piece = 0;
+    uint8_t captured = 0;
+    int32_t score = 0;
+    ScoredMove() = default;
+    ScoredMove(Move m, int pc, int cap) : move(m), piece((uint8_t)pc), captured((uint8_t)cap) {}
+};
+static_assert(sizeof(ScoredMove) == 8, "ScoredMove should pack into 8 bytes");
+
 constexpr int FLAG_NORMAL = 0;
 constexpr int FLAG_CASTLE = 1;
 constexpr int FLAG_EP = 2;
@@ -49,35 +72,116 @@ constexpr int PROMO_B = 1;
 constexpr int PROMO_R = 2;
 constexpr int PROMO_Q = 3;
 
-struct BoardState {
-    // 0=none,1=wP,2=wN,3=wB,4=wR,5=wQ,6=wK,7=bP,8=bN,9=bB,10=bR,11=bQ,12=bK
-    std::array<int,64> squares{};
-    // Castling rights: bit0=wK, bit1=wQ, bit2=bK, bit3=bQ
-    int castling = 0;
-    Square epSquare = NO_SQ;
-    int halfmove = 0;
-    int fullmove = 1;
-    Color sideToMove = WHITE;
+// The searchable state of a game: everything make/unmake, movegen and eval
+// read, and nothing else. Trivially copyable, with no heap storage, so a
+// position can be cloned to another thread or cache with one memcpy (the
+// game history stays in Board). Hot bitboards and keys come first.
+struct alignas(64) Position {
+    // Bitboards mirroring squares: byType[NONE] holds every occupied square
+    Bitboard byType[7]{};
+    Bitboard byColor[2]{};
     uint64_t zobrist = 0;
-    Move lastMove;
-    int capturedPiece = 0; // for unmake
-    int prevCastling = 0;
-    Square prevEP = NO_SQ;
-    int prevHalfmove = 0;
+    // Secondary keys kept by the placement primitives: pawns+kings only,
+    // and piece counts only, for pawn-structure and material caches
+    uint64_t pawnKey = 0;
+    uint64_t materialKey = 0;
+    Color sideToMove = WHITE;
+    // Running material+PST totals (White-positive, see eval/PST.h) and
+    // game phase, so the base evaluation costs O(1)
+    int32_t psqMg = 0, psqEg = 0;
+    uint8_t phase = 0;
+    // Castling rights: bit0=wK, bit1=wQ, bit2=bK, bit3=bQ
+    uint8_t castling = 0;
+    int8_t epSquare = NO_SQ;
+    int8_t kingSq[2] = {NO_SQ, NO_SQ};
+    uint16_t halfmove = 0;
+    uint16_t fullmove = 1;
+    // Plies since the last null move or position load: how far back the
+    // key history is a real game line
+    uint16_t pliesFromNull = 0;
+    // 0=none,1=wP,2=wN,3=wB,4=wR,5=wQ,6=wK,7=bP,8=bN,9=bB,10=bR,11=bQ,12=bK
+    std::array<uint8_t,64> squares{};
+    // Piece lists per piece code, with each square's slot in its list so
+    // pieces can be removed in O(1). At most 10 of a kind (8 promotions).
+    uint8_t pieceList[13][10]{};
+    uint8_t pieceCount[13]{};
+    uint8_t listIndex[64]{};
+};
+static_assert(std::is_trivially_copyable_v<Position>, "Position must be memcpy-able");
+
+// Per-ply undo record: only what makeMove destroys and unmakeMove can't
+// recompute from the move itself (10 bytes instead of a full Position).
+// The Zobrist key is kept apart in Board::keyHistory.
+struct UndoInfo {
+    Move move;
+    uint8_t captured = 0;   // piece removed by the move (incl. en passant)
+    uint8_t castling = 0;
+    int8_t epSquare = NO_SQ;
+    uint16_t halfmove = 0;
+    uint16_t pliesFromNull = 0;
+};
+
+// Fixed-size binary position (32 bytes, same bytes on every platform):
+//   0-7   occupancy bitboard, little-endian
+//   8-23  piece codes (1-12) of the occupied squares from a1 up, 4 bits
+//         each, low nibble first (at most 32 pieces)
+//   24    bit 0 side to move, bits 1-4 castling rights
+//   25    en passant square, 0xFF if none
+//   26-27 halfmove clock, 28-29 fullmove number (little-endian, clamped
+//         to 65535), 30-31 zero
+struct PackedBoard {
+    uint8_t bytes[32]{};
+    bool operator==(const PackedBoard& o) const;
+};
+
+// Check and pin data for the side to move, computed once per node so
+// pseudo-legal moves can be tested without making them
+struct CheckInfo {
+    Square kingSq = NO_SQ;
+    Bitboard checkers = 0;      // enemy pieces giving check
+    Bitboard pinned = 0;        // own pieces pinned to the king
+    Bitboard evasionMask = ~0ULL; // in check: checker + blocking squares (0 if double check)
+    // Enemy king: squares each piece type would give check from, and own
+    // pieces that uncover a check when they leave the line
+    Square theirKingSq = NO_SQ;
+    Bitboard checkSquares[7]{};
+    Bitboard discoverers = 0;
 };
 
 class Board {
 public:
     Board();
-    void loadFEN(const std::string& fen);
+    // Parse a FEN (or the first four fields of an EPD line; the clocks are
+    // optional). Returns false and leaves the board unchanged if malformed.
+    bool loadFEN(std::string_view fen);
+    // Write the FEN into out (at least MAX_FEN_LEN chars, NUL-terminated);
+    // returns its length. Never allocates.
+    int writeFEN(char* out) const;
     std::string toFEN() const;
+    // Binary encoding (see PackedBoard); unpack returns false and leaves
+    // the board unchanged if the data doesn't describe a valid position
+    PackedBoard pack() const { return pack(state); }
+    bool unpack(const PackedBoard& p);
+    static PackedBoard pack(const Position& pos);
+    // Batch forms over contiguous arrays; unpackBatch returns the number of
+    // valid entries (invalid ones are left as an empty Position)
+    static void packBatch(const Position* in, PackedBoard* out, size_t n);
+    static size_t unpackBatch(const PackedBoard* in, Position* out, size_t n);
+
+    static constexpr const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+    static constexpr int MAX_FEN_LEN = 128;
     void print(bool flipped = false) const;
 
     bool makeMove(Move m);   // returns false if illegal (leaves in check)
+    void doMove(Move m);     // makes a move already known to be legal (see isLegal)
     void unmakeMove();
+    // Pass the move (for null move pruning): flips side, clears en passant.
+    // Repetition detection never looks back past a null move.
+    void makeNullMove();
+    void unmakeNullMove();
 
-    std::vector<Move> history;
-    std::vector<BoardState> stateHistory;
+    // Undo stack capacity reserved up front so makeMove never allocates
+    static constexpr int MAX_GAME_PLY = 1024;
 
     // Current state accessors
     int pieceAt(Square s) const { return state.squares[s]; }
@@ -87,21 +191,73 @@ public:
     int halfmove() const { return state.halfmove; }
     int fullmove() const { return state.fullmove; }
     uint64_t zobrist() const { return state.zobrist; }
+    uint64_t pawnKey() const { return state.pawnKey; }
+    uint64_t materialKey() const { return state.materialKey; }
 
     bool isInCheck(Color c) const;
     bool isSquareAttacked(Square s, Color byColor) const;
+    // Pieces of both colors attacking s, with sliders seen through occ (a
+    // captured or moved piece can be taken out of occ by the caller; mask
+    // the result with occ to drop it as an attacker)
+    Bitboard attackersTo(Square s, Bitboard occ) const;
+    Bitboard attackersTo(Square s) const { return attackersTo(s, state.byType[NONE]); }
+
+    // Whether byColor attacks any of the given squares
+    bool anyAttacked(Bitboard squares, Color byColor) const;
+
+    // Legality without make/unmake: m must be pseudo-legal for the side to
+    // move (castling is taken as legal, since generation checks its squares)
+    CheckInfo checkInfo() const;
+    // Whether m is a move the pseudo-legal generator could produce here.
+    // Validates moves from outside the current node (TT move, killers)
+    // before they are tried without generating the move list.
+    bool isPseudoLegal(Move m) const;
+    bool isLegal(Move m, const CheckInfo& ci) const;
+    bool isLegal(Move m) const { return isLegal(m, checkInfo()); }
+    // Whether a pseudo-legal move checks the opponent, without making it
+    bool givesCheck(Move m, const CheckInfo& ci) const;
+    bool givesCheck(Move m) const { return givesCheck(m, checkInfo()); }
+    // Static exchange evaluation: material result of the capture sequence on
+    // m's target square, least valuable attacker first, x-rays included
+    int see(Move m) const;
+    bool seeGE(Move m, int threshold) const; // see(m) >= threshold, with early exits
     bool isDraw() const; // 50-move, repetition
-    bool isCheckmate();
-    bool isStalemate();
+    // True if the side to move has a reversible move reaching a position
+    // already seen inside the search (ply plies below the root), so the
+    // line can be scored as a draw before the repetition is played
+    bool hasUpcomingRepetition(int ply) const;
+    // Whether the side to move has any legal move; stops at the first one
+    bool hasLegalMove() const;
+    bool isCheckmate() const;
+    bool isStalemate() const;
 
     // For evaluation
-    int countPiece(Color c, Piece p) const;
-    Bitboard pieceBB(Color c, Piece p) const; // returns bitboard of piece locations
+    int countPiece(Color c, Piece p) const { return state.pieceCount[makePiece(c,p)]; }
+    bool hasNonPawnMaterial(Color c) const {
+        return state.byColor[c] & ~(state.byType[PAWN]|state.byType[KING]);
+    }
+    Bitboard pieceBB(Color c, Piece p) const { return state.byType[p] & state.byColor[c]; }
+    Bitboard pieces(Piece p) const { return state.byType[p]; }
+    Bitboard occupancy(Color c) const { return state.byColor[c]; }
+    Bitboard occupied() const { return state.byType[NONE]; }
+    // Squares of all pieces of one kind (countPiece entries, unordered)
+    const uint8_t* pieceList(Color c, Piece p) const { return state.pieceList[makePiece(c,p)]; }
+    Square kingSquare(Color c) const { return state.kingSq[c]; }
+    int psqMg() const { return state.psqMg; }
+    int psqEg() const { return state.psqEg; }
+    int phase() const { return state.phase; } // unclamped: may exceed 24 after promotions
 
-    const BoardState& getState() const { return state; }
+    // The current position without the game record, e.g. to hand to
+    // another thread; a Board built from it starts a fresh history
+    const Position& position() const { return state; }
+    explicit Board(const Position& pos);
 
 private:
-    BoardState state;
+    Position state;
+    std::vector<UndoInfo> undoStack;
+    // Zobrist key before each move on undoStack, packed so the repetition
+    // scan touches 8 bytes per ply
+    std::vector<uint64_t> keyHistory;
     // Zobrist keys
     static uint64_t zKeys[13][64];
     static uint64_t zSide;
@@ -109,9 +265,30 @@ private:
     static uint64_t zEP[8];
     static bool zInitialized;
     static void initZobrist();
+    // Cuckoo tables of reversible piece moves, keyed by the Zobrist
+    // difference they make (for hasUpcomingRepetition)
+    static uint64_t cuckooKey[8192];
+    static Move cuckooMove[8192];
+    static void initCuckoo();
     void recomputeZobrist();
 
+    // Piece placement: keep squares, bitboards, piece lists and the pawn and
+    // material keys in sync (the main Zobrist key is left to the caller)
+    void putPiece(Square s, int pc);
+    void removePiece(Square s);
+    void movePiece(Square from, Square to);
+    // Same as above, also updating the Zobrist key
     void setPiece(Square s, int pc);
     void clearPiece(Square s);
     int repetitionCount() const;
+    // Attack set of the piece on s
+    Bitboard pieceAttacks(Square s, Bitboard occ) const;
+
+    // Color-specific make/unmake: directions, ranks and piece codes are
+    // compile-time constants. doMove/unmakeMove dispatch once on the side.
+    template<Color Us> void doMoveImpl(Move m);
+    template<Color Us> void unmakeMoveImpl();
+    // Attack test against an arbitrary occupancy; only pieces of byColor
+    // still present in occ count as attackers
+    bool isSquareAttacked(Square s, Color byColor, Bitboard occ) const;
 };
@@ -62,15 +62,15 @@ void CLI::selectMode() {
 }
 
 bool CLI::gameOver(std::string& result) {
-    auto legal = MoveGen::generateLegalMoves(board);
-    if (legal.empty()) {
-        if (board.isInCheck(board.sideToMove())) {
-            result = (board.sideToMove()==WHITE) ? "0-1" : "1-0";
-            std::cout << "\nCheckmate! " << result << "\n";
-        } else {
-            result = "1/2-1/2";
-            std::cout << "\nStalemate! Draw.\n";
-        }
+    // Only one of these searches for a legal move, depending on check
+    if (board.isCheckmate()) {
+        result = (board.sideToMove()==WHITE) ? "0-1" : "1-0";
+        std::cout << "\nCheckmate! " << result << "\n";
+        return true;
+    }
+    if (board.isStalemate()) {
+        result = "1/2-1/2";
+        std::cout << "\nStalemate! Draw.\n";
         return true;
     }
     if (board.isDraw()) {
@@ -1,119 +1,8 @@
 #include "Eval.h"
+#include "../board/Attacks.h"
 #include <array>
 #include <cmath>
 
-// Piece-square tables (from White's perspective, a1=0)
-// Arranged rank 1..8 bottom to top
-
-static const int PST_PAWN_MG[64] = {
-     0,  0,  0,  0,  0,  0,  0,  0,
-    50, 50, 50, 50, 50, 50, 50, 50,
-    10, 10, 20, 30, 30, 20, 10, 10,
-     5,  5, 10, 25, 25, 10,  5,  5,
-     0,  0,  0, 20, 20,  0,  0,  0,
-     5, -5,-10,  0,  0,-10, -5,  5,
-     5, 10, 10,-20,-20, 10, 10,  5,
-     0,  0,  0,  0,  0,  0,  0,  0
-};
-
-static const int PST_PAWN_EG[64] = {
-     0,  0,  0,  0,  0,  0,  0,  0,
-    80, 80, 80, 80, 80, 80, 80, 80,
-    50, 50, 50, 50, 50, 50, 50, 50,
-    30, 30, 30, 30, 30, 30, 30, 30,
-    20, 20, 20, 20, 20, 20, 20, 20,
-    10, 10, 10, 10, 10, 10, 10, 10,
-     5,  5,  5,  5,  5,  5,  5,  5,
-     0,  0,  0,  0,  0,  0,  0,  0
-};
-
-static const int PST_KNIGHT[64] = {
-    -50,-40,-30,-30,-30,-30,-40,-50,
-    -40,-20,  0,  0,  0,  0,-20,-40,
-    -30,  0, 10, 15, 15, 10,  0,-30,
-    -30,  5, 15, 20, 20, 15,  5,-30,
-    -30,  0, 15, 20, 20, 15,  0,-30,
-    -30,  5, 10, 15, 15, 10,  5,-30,
-    -40,-20,  0,  5,  5,  0,-20,-40,
-    -50,-40,-30,-30,-30,-30,-40,-50
-};
-
-static const int PST_BISHOP[64] = {
-    -20,-10,-10,-10,-10,-10,-10,-20,
-    -10,  0,  0,  0,  0,  0,  0,-10,
-    -10,  0,  5, 10, 10,  5,  0,-10,
-    -10,  5,  5, 10, 10,  5,  5,-10,
-    -10,  0, 10, 10, 10, 10,  0,-10,
-    -10, 10, 10, 10, 10, 10, 10,-10,
-    -10,  5,  0,  0,  0,  0,  5,-10,
-    -20,-10,-10,-10,-10,-10,-10,-20
-};
-
-static const int PST_ROOK[64] = {
-     0,  0,  0,  0,  0,  0,  0,  0,
-     5, 10, 10, 10, 10, 10, 10,  5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-     0,  0,  0,  5,  5,  0,  0,  0
-};
-
-static const int PST_QUEEN[64] = {
-    -20,-10,-10, -5, -5,-10,-10,-20,
-    -10,  0,  0,  0,  0,  0,  0,-10,
-    -10,  0,  5,  5,  5,  5,  0,-10,
-     -5,  0,  5,  5,  5,  5,  0, -5,
-      0,  0,  5,  5,  5,  5,  0, -5,
-    -10,  5,  5,  5,  5,  5,  0,-10,
-    -10,  0,  5,  0,  0,  0,  0,-10,
-    -20,-10,-10, -5, -5,-10,-10,-20
-};
-
-static const int PST_KING_MG[64] = {
-    -30,-40,-40,-50,-50,-40,-40,-30,
-    -30,-40,-40,-50,-50,-40,-40,-30,
-    -30,-40,-40,-50,-50,-40,-40,-30,
-    -30,-40,-40,-50,-50,-40,-40,-30,
-    -20,-30,-30,-40,-40,-30,-30,-20,
-    -10,-20,-20,-20,-20,-20,-20,-10,
-     20, 20,  0,  0,  0,  0, 20, 20,
-     20, 30, 10,  0,  0, 10, 30, 20
-};
-
-static const int PST_KING_EG[64] = {
-    -50,-40,-30,-20,-20,-30,-40,-50,
-    -30,-20,-10,  0,  0,-10,-20,-30,
-    -30,-10, 20, 30, 30, 20,-10,-30,
-    -30,-10, 30, 40, 40, 30,-10,-30,
-    -30,-10, 30, 40, 40, 30,-10,-30,
-    -30,-10, 20, 30, 30, 20,-10,-30,
-    -30,-30,  0,  0,  0,  0,-30,-30,
-    -50,-30,-30,-30,-30,-30,-30,-50
-};
-
-static int flipSq(int s) {
-    // Flip square vertically (mirror rank)
-    return (7-(s/8))*8 + (s%8);
-}
-
-static int getPST(Piece pt, Color c, int sq, bool endgame) {
-    // PST tables are indexed with rank1=row0 (a1=index 0).
-    // White: use square directly (a1=0 is White's back rank).
-    // Black: flip rank so Black's back rank (a8=56) maps to index 0.
-    int s = (c==BLACK) ? flipSq(sq) : sq;
-    switch(pt) {
-        case PAWN:   return endgame ? PST_PAWN_EG[s] : PST_PAWN_MG[s];
-        case KNIGHT: return PST_KNIGHT[s];
-        case BISHOP: return PST_BISHOP[s];
-        case ROOK:   return PST_ROOK[s];
-        case QUEEN:  return PST_QUEEN[s];
-        case KING:   return endgame ? PST_KING_EG[s] : PST_KING_MG[s];
-        default: return 0;
-    }
-}
-
 int Eval::materialValue(int pc) {
     if (!pc) return 0;
     static const int vals[] = {0,PAWN_VAL,KNIGHT_VAL,BISHOP_VAL,ROOK_VAL,QUEEN_VAL,KING_VAL,
@@ -122,33 +11,22 @@ int Eval::materialValue(int pc) {
 }
 
 int Eval::gamePhase(const Board& board) {
-    // Phase: count minor/major pieces (max=24)
-    int phase = 0;
-    for (int s=0;s<64;s++) {
-        int pc=board.pieceAt(s);
-        Piece pt=pieceType(pc);
-        if (pt==KNIGHT||pt==BISHOP) phase+=1;
-        if (pt==ROOK) phase+=2;
-        if (pt==QUEEN) phase+=4;
-    }
-    return std::min(phase,24);
+    // Phase: minor/major pieces (max=24), kept incrementally by Board
+    return std::min(board.phase(),24);
 }
 
 static int evaluatePawnStructure(const Board& board, Color c) {
     Color opp = (c==WHITE)?BLACK:WHITE;
     int score = 0;
-    int myPawn = makePiece(c,PAWN);
     int oppPawn = makePiece(opp,PAWN);
 
     // Count pawns per file
     int myFiles[8]={}, oppFiles[8]={};
-    for (int s=0;s<64;s++) {
-        if (board.pieceAt(s)==myPawn) myFiles[s%8]++;
-        if (board.pieceAt(s)==oppPawn) oppFiles[s%8]++;
-    }
+    for (Bitboard b=board.pieceBB(c,PAWN); b; ) myFiles[popLsb(b)%8]++;
+    for (Bitboard b=board.pieceBB(opp,PAWN); b; ) oppFiles[popLsb(b)%8]++;
 
-    for (int s=0;s<64;s++) {
-        if (board.pieceAt(s)!=myPawn) continue;
+    for (Bitboard pawns=board.pieceBB(c,PAWN); pawns; ) {
+        int s=popLsb(pawns);
         int f=s%8, r=s/8;
 
         // Doubled pawn penalty
@@ -215,22 +93,37 @@ static int evaluatePawnStructure(const Board& board, Color c) {
     return score;
 }
 
+// Pawn hash table: pawn structure only depends on pawn placement, so the
+// White-minus-Black score is cached by Board::pawnKey()
+struct PawnEntry {
+    uint64_t key = 0;
+    int score = 0;
+};
+static constexpr int PAWN_TABLE_SIZE = (1<<14); // 16K entries
+static PawnEntry pawnTable[PAWN_TABLE_SIZE];
+
+static int probePawnStructure(const Board& board) {
+    uint64_t key = board.pawnKey();
+    PawnEntry& e = pawnTable[key & (PAWN_TABLE_SIZE-1)];
+    if (e.key != key) {
+        e.key = key;
+        e.score = evaluatePawnStructure(board, WHITE) - evaluatePawnStructure(board, BLACK);
+    }
+    return e.score;
+}
+
 static int evaluateRooks(const Board& board, Color c) {
     int score=0;
-    int myR=makePiece(c,ROOK);
-    int myP=makePiece(c,PAWN);
-    int oppP=makePiece((c==WHITE)?BLACK:WHITE,PAWN);
+    Color opp=(c==WHITE)?BLACK:WHITE;
     int seventhRank=(c==WHITE)?6:1;
 
     // Count my/opp pawns per file
     bool myPawnOnFile[8]={}, oppPawnOnFile[8]={};
-    for (int s=0;s<64;s++) {
-        if (board.pieceAt(s)==myP) myPawnOnFile[s%8]=true;
-        if (board.pieceAt(s)==oppP) oppPawnOnFile[s%8]=true;
-    }
+    for (Bitboard b=board.pieceBB(c,PAWN); b; ) myPawnOnFile[popLsb(b)%8]=true;
+    for (Bitboard b=board.pieceBB(opp,PAWN); b; ) oppPawnOnFile[popLsb(b)%8]=true;
 
-    for (int s=0;s<64;s++) {
-        if (board.pieceAt(s)!=myR) continue;
+    for (Bitboard rooks=board.pieceBB(c,ROOK); rooks; ) {
+        int s=popLsb(rooks);
         int f=s%8, r=s/8;
         if (!myPawnOnFile[f]) {
             if (!oppPawnOnFile[f]) score+=20; // open file
@@ -244,10 +137,8 @@ static int evaluateRooks(const Board& board, Color c) {
 static int evaluateKingSafety(const Board& board, Color c, int phase) {
     Color opp=(c==WHITE)?BLACK:WHITE;
     int score=0;
-    int myK=makePiece(c,KING);
-    Square ks=-1;
-    for (int s=0;s<64;s++) if (board.pieceAt(s)==myK) { ks=s; break; }
-    if (ks<0) return 0;
+    Square ks=board.kingSquare(c);
+    if (ks==NO_SQ) return 0;
     
     int kr=ks/8, kf=ks%8;
     int myP=makePiece(c,PAWN);
@@ -267,77 +158,29 @@ static int evaluateKingSafety(const Board& board, Color c, int phase) {
         if (kf>=2&&kf<=5) score-=20;
     }
 
-    // Count attackers near king (simplified)
-    int attackers=0;
-    for (int ds=-2;ds<=2;ds++) for (int df=-2;df<=2;df++) {
-        int ts=ks+ds*8+df;
-        if (ts<0||ts>63) continue;
-        int pc=board.pieceAt(ts);
-        if (pc && pieceColor(pc)==opp && pieceType(pc)!=PAWN) attackers++;
-    }
-    score -= attackers*8;
+    // Enemy pieces (other than pawns and king) attacking the king or a
+    // square next to it
+    Bitboard zone=kingAttacks(ks)|squareBB(ks), attackers=0;
+    Bitboard enemy=board.occupancy(opp) & ~(board.pieces(PAWN)|board.pieces(KING));
+    while (zone) attackers |= board.attackersTo(popLsb(zone)) & enemy;
+    score -= popcount(attackers)*8;
 
     return score;
 }
 
 static int mobility(const Board& board, Color c) {
-    // Count squares attacked/reachable by pieces (simplified)
-    // Count pseudo-legal moves for bishops, knights, queens, rooks
+    // Squares each piece reaches that aren't blocked by its own side
     int score=0;
-    Color opp=(c==WHITE)?BLACK:WHITE;
-    
-    for (int s=0;s<64;s++) {
-        int pc=board.pieceAt(s);
-        if (!pc||pieceColor(pc)!=c) continue;
-        Piece pt=pieceType(pc);
-        if (pt==PAWN||pt==KING) continue;
-        
-        int moves=0;
-        if (pt==KNIGHT) {
-            int off[]={-17,-15,-10,-6,6,10,15,17};
-            for (int o:off) {
-                int t=s+o;
-                if (t<0||t>63) continue;
-                int df=abs(t%8-s%8);
-                if (df!=1&&df!=2) continue;
-                int cap=board.pieceAt(t);
-                if (!cap||pieceColor(cap)!=c) moves++;
-            }
-            score+=moves*2;
-        } else if (pt==BISHOP||pt==QUEEN) {
-            int dirs[]={9,-9,7,-7};
-            for (int d:dirs) {
-                int t=s;
-                while(true) {
-                    int nt=t+d;
-                    if (nt<0||nt>63) break;
-                    if (abs(nt%8-t%8)!=1) break;
-                    int cap=board.pieceAt(nt);
-                    if (cap&&pieceColor(cap)==c) break;
-                    moves++;
-                    if (cap) break;
-                    t=nt;
-                }
-            }
-            if (pt==BISHOP) score+=moves*2;
-        }
-        if (pt==ROOK||pt==QUEEN) {
-            int dirs[]={1,-1,8,-8};
-            for (int d:dirs) {
-                int t=s;
-                while(true) {
-                    int nt=t+d;
-                    if (nt<0||nt>63) break;
-                    if (abs(d)==1&&nt/8!=s/8) break;
-                    int cap=board.pieceAt(nt);
-                    if (cap&&pieceColor(cap)==c) break;
-                    moves++;
-                    if (cap) break;
-                    t=nt;
-                }
-            }
-            if (pt==ROOK) score+=moves;
-            if (pt==QUEEN) score+=moves;
+    Bitboard occ=board.occupied(), notOwn=~board.occupancy(c);
+    Bitboard pcs=board.occupancy(c) & ~(board.pieces(PAWN)|board.pieces(KING));
+    while (pcs) {
+        int s=popLsb(pcs);
+        switch (pieceType(board.pieceAt(s))) {
+            case KNIGHT: score += popcount(knightAttacks(s) & notOwn)*2; break;
+            case BISHOP: score += popcount(bishopAttacks(s,occ) & notOwn)*2; break;
+            case ROOK:   score += popcount(rookAttacks(s,occ) & notOwn); break;
+            case QUEEN:  score += popcount(queenAttacks(s,occ) & notOwn); break;
+            default: break;
         }
     }
     return score;
@@ -345,28 +188,12 @@ static int mobility(const Board& board, Color c) {
 
 int Eval::evaluate(const Board& board) {
     int phase = gamePhase(board);
-    bool endgame = (phase < 10);
-    float eg = 1.0f - (float)phase/24.0f;
 
-    int score = 0;
-
-    // Material + PST
-    for (int s=0;s<64;s++) {
-        int pc=board.pieceAt(s);
-        if (!pc) continue;
-        Color c=pieceColor(pc);
-        Piece pt=pieceType(pc);
-        int val = materialValue(pc);
-        int pst_mg = getPST(pt,c,s,false);
-        int pst_eg = getPST(pt,c,s,true);
-        int pst = (int)(pst_mg*(1-eg) + pst_eg*eg);
-        int total = val + pst;
-        if (c==WHITE) score+=total; else score-=total;
-    }
+    // Material + PST: running totals tapered by phase
+    int score = (board.psqMg()*phase + board.psqEg()*(24-phase)) / 24;
 
-    // Pawn structure
-    score += evaluatePawnStructure(board, WHITE);
-    score -= evaluatePawnStructure(board, BLACK);
+    // Pawn structure (cached by pawn key)
+    score += probePawnStructure(board);
 
     // Rooks
     score += evaluateRooks(board, WHITE);
@@ -0,0 +1,137 @@
+#pragma once
+#include "Eval.h"
+
+namespace PST {
+
+// Piece-square tables (from White's perspective, a1=0)
+// Arranged rank 1..8 bottom to top
+
+inline constexpr int PST_PAWN_MG[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    10, 10, 20, 30, 30, 20, 10, 10,
+     5,  5, 10, 25, 25, 10,  5,  5,
+     0,  0,  0, 20, 20,  0,  0,  0,
+     5, -5,-10,  0,  0,-10, -5,  5,
+     5, 10, 10,-20,-20, 10, 10,  5,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+
+inline constexpr int PST_PAWN_EG[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    80, 80, 80, 80, 80, 80, 80, 80,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    30, 30, 30, 30, 30, 30, 30, 30,
+    20, 20, 20, 20, 20, 20, 20, 20,
+    10, 10, 10, 10, 10, 10, 10, 10,
+     5,  5,  5,  5,  5,  5,  5,  5,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+
+inline constexpr int PST_KNIGHT[64] = {
+    -50,-40,-30,-30,-30,-30,-40,-50,
+    -40,-20,  0,  0,  0,  0,-20,-40,
+    -30,  0, 10, 15, 15, 10,  0,-30,
+    -30,  5, 15, 20, 20, 15,  5,-30,
+    -30,  0, 15, 20, 20, 15,  0,-30,
+    -30,  5, 10, 15, 15, 10,  5,-30,
+    -40,-20,  0,  5,  5,  0,-20,-40,
+    -50,-40,-30,-30,-30,-30,-40,-50
+};
+
+inline constexpr int PST_BISHOP[64] = {
+    -20,-10,-10,-10,-10,-10,-10,-20,
+    -10,  0,  0,  0,  0,  0,  0,-10,
+    -10,  0,  5, 10, 10,  5,  0,-10,
+    -10,  5,  5, 10, 10,  5,  5,-10,
+    -10,  0, 10, 10, 10, 10,  0,-10,
+    -10, 10, 10, 10, 10, 10, 10,-10,
+    -10,  5,  0,  0,  0,  0,  5,-10,
+    -20,-10,-10,-10,-10,-10,-10,-20
+};
+
+inline constexpr int PST_ROOK[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+     5, 10, 10, 10, 10, 10, 10,  5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+     0,  0,  0,  5,  5,  0,  0,  0
+};
+
+inline constexpr int PST_QUEEN[64] = {
+    -20,-10,-10, -5, -5,-10,-10,-20,
+    -10,  0,  0,  0,  0,  0,  0,-10,
+    -10,  0,  5,  5,  5,  5,  0,-10,
+     -5,  0,  5,  5,  5,  5,  0, -5,
+      0,  0,  5,  5,  5,  5,  0, -5,
+    -10,  5,  5,  5,  5,  5,  0,-10,
+    -10,  0,  5,  0,  0,  0,  0,-10,
+    -20,-10,-10, -5, -5,-10,-10,-20
+};
+
+inline constexpr int PST_KING_MG[64] = {
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -20,-30,-30,-40,-40,-30,-30,-20,
+    -10,-20,-20,-20,-20,-20,-20,-10,
+     20, 20,  0,  0,  0,  0, 20, 20,
+     20, 30, 10,  0,  0, 10, 30, 20
+};
+
+inline constexpr int PST_KING_EG[64] = {
+    -50,-40,-30,-20,-20,-30,-40,-50,
+    -30,-20,-10,  0,  0,-10,-20,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-30,  0,  0,  0,  0,-30,-30,
+    -50,-30,-30,-30,-30,-30,-30,-50
+};
+
+// Material + PST per piece code and square, signed White-positive, so a
+// position's totals can be kept incrementally by Board as pieces move
+struct Table {
+    int mg[13][64];
+    int eg[13][64];
+};
+
+constexpr Table buildTable() {
+    Table t{};
+    const int vals[] = {0,Eval::PAWN_VAL,Eval::KNIGHT_VAL,Eval::BISHOP_VAL,
+                        Eval::ROOK_VAL,Eval::QUEEN_VAL,Eval::KING_VAL};
+    for (int pc=1;pc<=12;pc++) {
+        Color c = pieceColor(pc);
+        Piece pt = pieceType(pc);
+        int sign = (c==WHITE) ? 1 : -1;
+        for (int sq=0;sq<64;sq++) {
+            // Black: flip rank so Black's back rank (a8=56) maps to index 0
+            int s = (c==BLACK) ? (7-(sq/8))*8 + (sq%8) : sq;
+            int mg=0, eg=0;
+            switch(pt) {
+                case PAWN:   mg=PST_PAWN_MG[s]; eg=PST_PAWN_EG[s]; break;
+                case KNIGHT: mg=eg=PST_KNIGHT[s]; break;
+                case BISHOP: mg=eg=PST_BISHOP[s]; break;
+                case ROOK:   mg=eg=PST_ROOK[s]; break;
+                case QUEEN:  mg=eg=PST_QUEEN[s]; break;
+                case KING:   mg=PST_KING_MG[s]; eg=PST_KING_EG[s]; break;
+                default: break;
+            }
+            t.mg[pc][sq] = sign*(vals[pt]+mg);
+            t.eg[pc][sq] = sign*(vals[pt]+eg);
+        }
+    }
+    return t;
+}
+
+inline constexpr Table PSQ = buildTable();
+
+// Game phase contribution per piece type (N/B=1, R=2, Q=4; max 24)
+inline constexpr int PHASE[7] = {0,0,1,1,2,4,0};
+
+}
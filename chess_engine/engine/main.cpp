@@ -1,15 +1,25 @@
 #include "cli/CLI.h"
 #include "board/Board.h"
+#include "board/Attacks.h"
 #include "movegen/MoveGen.h"
+#include "search/Search.h"
+#include "util/FenFile.h"
+#include <chrono>
 #include <iostream>
 #include <string>
 
 int main(int argc, char* argv[]) {
+    Attacks::init();
+    std::cerr << "Slider attacks: " << Attacks::backendName() << "\n";
+
     // Check for perft test mode
     if (argc >= 3 && std::string(argv[1]) == "perft") {
         int depth = std::stoi(argv[2]);
         Board board;
-        if (argc >= 4) board.loadFEN(argv[3]);
+        if (argc >= 4 && !board.loadFEN(argv[3])) {
+            std::cerr << "Invalid FEN\n";
+            return 1;
+        }
         std::cout << "Running perft(" << depth << ")...\n";
         uint64_t nodes = MoveGen::perft(board, depth);
         std::cout << "Nodes: " << nodes << "\n";
@@ -19,13 +29,57 @@ int main(int argc, char* argv[]) {
     // Check for FEN mode
     if (argc >= 3 && std::string(argv[1]) == "fen") {
         Board board;
-        board.loadFEN(argv[2]);
+        if (!board.loadFEN(argv[2])) {
+            std::cerr << "Invalid FEN\n";
+            return 1;
+        }
         board.print(true);
         auto legal = MoveGen::generateLegalMoves(board);
         std::cout << "Legal moves: " << legal.size() << "\n";
         return 0;
     }
 
+    // Bulk load mode: parse every line of a FEN/EPD file and report speed
+    if (argc >= 3 && std::string(argv[1]) == "epd") {
+        auto t0 = std::chrono::steady_clock::now();
+        long long bad = 0, positions = 0;
+        long long n = FenFile::forEach(argv[2], [&](const Board&, std::string_view) { positions++; }, &bad);
+        if (n < 0) {
+            std::cerr << "Cannot open " << argv[2] << "\n";
+            return 1;
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::cout << "Loaded " << positions << " positions (" << bad << " malformed) in "
+                  << secs << "s\n";
+        return 0;
+    }
+
+    // Bench mode: fixed-depth searches of a fixed position set; prints the
+    // total node count (a search signature) and the speed
+    if (argc >= 2 && std::string(argv[1]) == "bench") {
+        int depth = argc >= 3 ? std::stoi(argv[2]) : 7;
+        static const char* BENCH_FENS[] = {
+            Board::START_FEN,
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P3/2NP1N2/PPP1QPPP/R4RK1 w - - 0 10",
+            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1",
+        };
+        long long nodes = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (const char* fen : BENCH_FENS) {
+            Board board;
+            board.loadFEN(fen);
+            Search search;
+            search.findBestMove(board, 1e9, depth);
+            nodes += search.nodesSearched;
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::cout << nodes << " nodes " << secs << "s " << (long long)(nodes / secs) << " nps\n";
+        return 0;
+    }
+
     CLI cli;
     cli.run();
     return 0;
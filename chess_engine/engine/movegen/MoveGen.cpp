@@ -1,276 +1,245 @@
 #include "MoveGen.h"
+#include "../board/Attacks.h"
 #include <iostream>
 
-static void addPawnMoves(const Board& board, std::vector<Move>& moves, bool capturesOnly) {
-    Color side = board.sideToMove();
-    int dir = (side==WHITE)?8:-8;
-    int startRank = (side==WHITE)?1:6;
-    int promoRank = (side==WHITE)?7:0;
-
-    int wP = makePiece(WHITE,PAWN), bP = makePiece(BLACK,PAWN);
-    int myPawn = (side==WHITE)?wP:bP;
-
-    for (int s=0;s<64;s++) {
-        if (board.pieceAt(s)!=myPawn) continue;
-        int f=s%8, r=s/8;
-
-        // Captures
-        for (int df : {-1,1}) {
-            int tf=f+df;
-            if (tf<0||tf>7) continue;
-            int t=s+dir+df;
-            if (t<0||t>63) continue;
-            // En passant
-            if (t==board.epSquare()) {
-                moves.push_back(Move(s,t,FLAG_EP));
-                continue;
-            }
-            int cap = board.pieceAt(t);
-            if (cap && pieceColor(cap)!=side) {
-                if (t/8==promoRank) {
-                    for (int p=0;p<4;p++) moves.push_back(Move(s,t,FLAG_PROMO,p));
-                } else {
-                    moves.push_back(Move(s,t,FLAG_NORMAL));
-                }
-            }
+// Appends a move to a plain list, or to a scored list together with the
+// moving and captured pieces. The generators are templated on the list, so
+// the piece lookups compile away for plain lists.
+static inline void addMove(MoveList<Move>& moves, Move m, int, int) { moves.push_back(m); }
+static inline void addMove(MoveList<ScoredMove>& moves, Move m, int pc, int cap) { moves.emplace_back(m, pc, cap); }
+
+// Pawn moves for a set of pawns at once with bitboard shifts, restricted to
+// destination squares in target. Us is a template parameter so directions
+// and ranks are compile-time constants. En passant is added separately.
+template<Color Us, GenType Type, class List>
+static void addPawnMoves(const Board& board, List& moves, Bitboard pawns, Bitboard target) {
+    constexpr Color Them = (Us==WHITE)?BLACK:WHITE;
+    constexpr int Up = (Us==WHITE)?8:-8;
+    constexpr int UpLeft = (Us==WHITE)?7:-9;
+    constexpr int UpRight = (Us==WHITE)?9:-7;
+    constexpr Bitboard Rank3 = relativeRankBB<Us>(2);
+    constexpr Bitboard Rank7 = relativeRankBB<Us>(6);
+
+    Bitboard promoters = pawns & Rank7, others = pawns & ~Rank7;
+    Bitboard enemies = board.occupancy(Them) & target;
+    Bitboard empty = ~board.occupied();
+    constexpr int Pawn = makePiece(Us,PAWN);
+
+    auto addPromos = [&](Bitboard to, int d) {
+        while (to) {
+            Square t=popLsb(to);
+            for (int p=0;p<4;p++) addMove(moves, Move(t-d,t,FLAG_PROMO,p), Pawn, board.pieceAt(t));
         }
+    };
+    auto addNormal = [&](Bitboard to, int d) {
+        while (to) { Square t=popLsb(to); addMove(moves, Move(t-d,t,FLAG_NORMAL), Pawn, board.pieceAt(t)); }
+    };
+
+    // Captures, including capture-promotions
+    if (Type != GEN_QUIETS) {
+        addNormal(shiftBB<UpLeft>(others) & enemies, UpLeft);
+        addNormal(shiftBB<UpRight>(others) & enemies, UpRight);
+        addPromos(shiftBB<UpLeft>(promoters) & enemies, UpLeft);
+        addPromos(shiftBB<UpRight>(promoters) & enemies, UpRight);
+    }
 
-        if (capturesOnly) continue;
+    // Pushes: single, double from the start rank, and push-promotions
+    if (Type != GEN_CAPTURES) {
+        Bitboard single = shiftBB<Up>(others) & empty;
+        Bitboard dbl = shiftBB<Up>(single & Rank3) & empty;
+        addNormal(single & target, Up);
+        addNormal(dbl & target, 2*Up);
+        addPromos(shiftBB<Up>(promoters) & empty & target, Up);
+    }
+}
 
-        // Forward
-        int fwd = s+dir;
-        if (fwd<0||fwd>63) continue;
-        if (board.pieceAt(fwd)==0) {
-            if (fwd/8==promoRank) {
-                for (int p=0;p<4;p++) moves.push_back(Move(s,fwd,FLAG_PROMO,p));
-            } else {
-                moves.push_back(Move(s,fwd,FLAG_NORMAL));
-                // Double push
-                if (r==startRank) {
-                    int dbl=fwd+dir;
-                    if (board.pieceAt(dbl)==0) moves.push_back(Move(s,dbl,FLAG_NORMAL));
-                }
-            }
+// En passant. The legal generator tests the position after the capture
+// directly: two pieces leave one rank, which can uncover a slider on the
+// king that no pin or evasion mask shows.
+template<Color Us, bool Legal, class List>
+static void addEnPassant(const Board& board, List& moves, Square ks) {
+    constexpr Color Them = (Us==WHITE)?BLACK:WHITE;
+    Square ep = board.epSquare();
+    if (ep==NO_SQ) return;
+    Square capSq = ep + (Us==WHITE?-8:8);
+    for (Bitboard b = board.pieceBB(Us,PAWN) & pawnAttacks(Them, ep); b; ) {
+        Square from = popLsb(b);
+        if (Legal) {
+            Bitboard occ = (board.occupied() ^ squareBB(from) ^ squareBB(capSq)) | squareBB(ep);
+            if (board.attackersTo(ks, occ) & board.occupancy(Them) & occ) continue;
         }
+        addMove(moves, Move(from,ep,FLAG_EP), makePiece(Us,PAWN), makePiece(Them,PAWN));
     }
 }
 
-static void addKnightMoves(const Board& board, std::vector<Move>& moves, bool capturesOnly) {
-    Color side = board.sideToMove();
-    int myN = makePiece(side,KNIGHT);
-    int offsets[] = {-17,-15,-10,-6,6,10,15,17};
-    for (int s=0;s<64;s++) {
-        if (board.pieceAt(s)!=myN) continue;
-        int sf=s%8,sr=s/8;
-        for (int o : offsets) {
-            int t=s+o;
-            if (t<0||t>63) continue;
-            int df=abs(t%8-sf),dr=abs(t/8-sr);
-            if (!((df==1&&dr==2)||(df==2&&dr==1))) continue;
-            int cap=board.pieceAt(t);
-            if (cap && pieceColor(cap)==side) continue; // own piece
-            if (capturesOnly && !cap) continue;
-            moves.push_back(Move(s,t,FLAG_NORMAL));
-        }
+// One move per target square; targets already exclude our own pieces
+template<class List>
+static void addMovesTo(const Board& board, List& moves, Square from, Bitboard targets) {
+    int pc = board.pieceAt(from);
+    while (targets) {
+        Square t = popLsb(targets);
+        addMove(moves, Move(from,t,FLAG_NORMAL), pc, board.pieceAt(t));
     }
 }
 
-static void addSlidingMoves(const Board& board, std::vector<Move>& moves, Piece ptype, bool capturesOnly) {
-    Color side = board.sideToMove();
-    int myPc = makePiece(side,ptype);
-    
-    int rookDirs[] = {1,-1,8,-8,0};
-    int bishDirs[] = {9,-9,7,-7,0};
-    int* dirs = (ptype==ROOK)?rookDirs:(ptype==BISHOP)?bishDirs:nullptr;
-    int allDirs[] = {1,-1,8,-8,9,-9,7,-7,0};
-    if (ptype==QUEEN) dirs = allDirs;
+// Knights and sliders. Pinned pieces (none for pseudo-legal generation)
+// keep to the line through their king: a pinned knight never can.
+template<Color Us, class List>
+static void addPieceMoves(const Board& board, List& moves, Bitboard targets, Bitboard pinned, Square ks) {
+    Bitboard occ = board.occupied();
 
-    for (int s=0;s<64;s++) {
-        if (board.pieceAt(s)!=myPc) continue;
-        for (int di=0;dirs[di]!=0;di++) {
-            int d=dirs[di];
-            int t=s+d;
-            while (t>=0&&t<64) {
-                // Check diagonal overflow
-                int df=abs(t%8-s%8), dr=abs(t/8-s/8);
-                int steps=std::max(df,dr);
-                if (df>steps||dr>steps) break; // impossible actually
-                // Simpler: check file wrap
-                if ((d==1||d==-1||d==9||d==-9||d==7||d==-7) && df!=dr && d!=1 && d!=-1) {
-                    // diagonal: check consistent
-                }
-                // Prevent rank wrapping for horizontal dirs
-                if ((d==1||d==-1) && (t/8)!=(s/8)) break;
-                // Prevent file wrapping for diagonal
-                if ((d==9||d==7) && (t%8)<=( (s%8))) { if(d==9&&t%8<=s%8) {} }
-                // Cleaner approach: just track file distance
-                {
-                    // recompute per step
-                    int sf=s%8;
-                    // Walk step by step, check file continuity
-                }
+    const uint8_t* knights = board.pieceList(Us,KNIGHT);
+    for (int i=0, n=board.countPiece(Us,KNIGHT); i<n; i++) {
+        if (!(pinned & squareBB(knights[i])))
+            addMovesTo(board, moves, knights[i], knightAttacks(knights[i]) & targets);
+    }
 
-                int cap=board.pieceAt(t);
-                if (cap && pieceColor(cap)==side) break;
-                if (!capturesOnly || cap) moves.push_back(Move(s,t,FLAG_NORMAL));
-                if (cap) break;
-                t+=d;
-                // Wrap check
-                if (t<0||t>63) break;
-                // Horizontal wrap
-                if ((d==1) && t%8==0) break;
-                if ((d==-1) && t%8==7) break;
-                // Diagonal wrap
-                if ((d==9||d==-7) && t%8==0) break;
-                if ((d==7||d==-9) && t%8==7) break;
-            }
+    for (Piece pt : {BISHOP,ROOK,QUEEN}) {
+        const uint8_t* list = board.pieceList(Us,pt);
+        for (int i=0, n=board.countPiece(Us,pt); i<n; i++) {
+            int s = list[i];
+            Bitboard att = pt==BISHOP ? bishopAttacks(s,occ)
+                         : pt==ROOK   ? rookAttacks(s,occ)
+                         : queenAttacks(s,occ);
+            if (pinned & squareBB(s)) att &= lineBB(ks, s);
+            addMovesTo(board, moves, s, att & targets);
         }
     }
 }
 
-// Better sliding move generator
-static void addSliding(const Board& board, std::vector<Move>& moves, bool capturesOnly) {
-    Color side = board.sideToMove();
-    Color opp = (side==WHITE)?BLACK:WHITE;
+// King steps, and castling for everything but captures. The legal
+// generator drops steps onto attacked squares, with the king taken off the
+// board so it can't hide behind itself on a checking slider's ray.
+template<Color Us, GenType Type, bool Legal, class List>
+static void addKingMoves(const Board& board, List& moves, Bitboard targets) {
+    constexpr Color Them = (Us==WHITE)?BLACK:WHITE;
+    Square s = board.kingSquare(Us);
+    if (s==NO_SQ) return;
+    Bitboard steps = kingAttacks(s) & targets;
+    if (Legal) {
+        Bitboard occ = board.occupied() ^ squareBB(s), theirs = board.occupancy(Them);
+        for (Bitboard b = steps; b; ) {
+            Square t = popLsb(b);
+            if (board.attackersTo(t, occ) & theirs) steps ^= squareBB(t);
+        }
+    }
+    addMovesTo(board, moves, s, steps);
+
+    if (Type == GEN_CAPTURES) return;
+
+    // Castling: squares between king and rook empty, and the king's
+    // start, transit and destination squares not attacked (so never out
+    // of check). Squares are given for White and moved to rank 8 for Black.
+    constexpr int Shift = (Us==WHITE)?0:56;
+    constexpr int KingSide = (Us==WHITE)?1:4, QueenSide = (Us==WHITE)?2:8;
+    int cr=board.castlingRights();
+    Bitboard occ=board.occupied();
+    if ((cr&KingSide) && !(occ & (0x60ULL<<Shift)) && !board.anyAttacked(0x70ULL<<Shift, Them))
+        addMove(moves, Move(4+Shift,6+Shift,FLAG_CASTLE), makePiece(Us,KING), 0);   // f1,g1 empty; e1-g1 safe
+    if ((cr&QueenSide) && !(occ & (0x0EULL<<Shift)) && !board.anyAttacked(0x1CULL<<Shift, Them))
+        addMove(moves, Move(4+Shift,2+Shift,FLAG_CASTLE), makePiece(Us,KING), 0);   // b1-d1 empty; c1-e1 safe
+}
 
-    for (int s=0;s<64;s++) {
-        int pc = board.pieceAt(s);
-        if (!pc || pieceColor(pc)!=side) continue;
-        Piece pt = pieceType(pc);
-        if (pt!=ROOK&&pt!=BISHOP&&pt!=QUEEN) continue;
+// Pseudo-legal generation (Legal=false) leaves pins and checks to
+// Board::isLegal. Legal generation emits only legal moves: king steps to
+// safe squares, then, unless in double check, other moves that capture or
+// block the checker (evasionMask), with pinned pieces kept on their pin ray.
+template<Color Us, GenType Type, bool Legal, class List>
+static void generate(const Board& board, List& moves) {
+    constexpr Color Them = (Us==WHITE)?BLACK:WHITE;
+    Bitboard targets = Type==GEN_CAPTURES ? board.occupancy(Them)
+                     : Type==GEN_QUIETS   ? ~board.occupied()
+                     : ~board.occupancy(Us);
+    Bitboard pawns = board.pieceBB(Us,PAWN);
+
+    if (!Legal) {
+        addPawnMoves<Us,Type>(board,moves,pawns,targets);
+        if (Type != GEN_QUIETS) addEnPassant<Us,false>(board,moves,NO_SQ);
+        addPieceMoves<Us>(board,moves,targets,0,NO_SQ);
+        addKingMoves<Us,Type,false>(board,moves,targets);
+        return;
+    }
 
-        bool isRook = (pt==ROOK||pt==QUEEN);
-        bool isBish = (pt==BISHOP||pt==QUEEN);
+    CheckInfo ci = board.checkInfo();
+    Square ks = ci.kingSq;
+    addKingMoves<Us,Type,true>(board,moves,targets);
+    if (ci.checkers & (ci.checkers-1)) return; // double check: king moves only
 
-        if (isRook) {
-            // Horizontal/vertical
-            int rdirs[] = {1,-1,8,-8};
-            for (int d : rdirs) {
-                int t=s;
-                while (true) {
-                    int nt=t+d;
-                    if (nt<0||nt>63) break;
-                    if (d==1&&nt%8==0) break;
-                    if (d==-1&&nt%8==7) break;
-                    // Check same rank for horiz
-                    if (abs(d)==1 && nt/8!=s/8) break;
-                    int cap=board.pieceAt(nt);
-                    if (cap && pieceColor(cap)==side) break;
-                    if (!capturesOnly||cap) moves.push_back(Move(s,nt,FLAG_NORMAL));
-                    if (cap) break;
-                    t=nt;
-                }
-            }
-        }
-        if (isBish) {
-            int bdirs[] = {9,-9,7,-7};
-            for (int d : bdirs) {
-                int t=s;
-                while (true) {
-                    int nt=t+d;
-                    if (nt<0||nt>63) break;
-                    int df=abs(nt%8-t%8);
-                    if (df!=1) break; // diagonal must step 1 file
-                    int cap=board.pieceAt(nt);
-                    if (cap && pieceColor(cap)==side) break;
-                    if (!capturesOnly||cap) moves.push_back(Move(s,nt,FLAG_NORMAL));
-                    if (cap) break;
-                    t=nt;
-                }
-            }
-        }
+    targets &= ci.evasionMask;
+    addPawnMoves<Us,Type>(board,moves,pawns & ~ci.pinned,targets);
+    for (Bitboard b = pawns & ci.pinned; b; ) {
+        Square s = popLsb(b);
+        addPawnMoves<Us,Type>(board,moves,squareBB(s),targets & lineBB(ks,s));
     }
+    if (Type != GEN_QUIETS && ks != NO_SQ) addEnPassant<Us,true>(board,moves,ks);
+    addPieceMoves<Us>(board,moves,targets,ci.pinned,ks);
 }
 
-static void addKingMoves(const Board& board, std::vector<Move>& moves, bool capturesOnly) {
-    Color side = board.sideToMove();
-    int myK = makePiece(side,KING);
-    int koffsets[] = {-9,-8,-7,-1,1,7,8,9};
-    
-    for (int s=0;s<64;s++) {
-        if (board.pieceAt(s)!=myK) continue;
-        int sf=s%8,sr=s/8;
-        for (int o : koffsets) {
-            int t=s+o;
-            if (t<0||t>63) continue;
-            if (abs(t%8-sf)>1||abs(t/8-sr)>1) continue;
-            int cap=board.pieceAt(t);
-            if (cap && pieceColor(cap)==side) continue;
-            if (capturesOnly && !cap) continue;
-            moves.push_back(Move(s,t,FLAG_NORMAL));
-        }
+template<GenType Type, bool Legal, class T>
+static void appendInto(const Board& board, MoveList<T>& moves) {
+    if (board.sideToMove()==WHITE) generate<WHITE,Type,Legal>(board,moves);
+    else generate<BLACK,Type,Legal>(board,moves);
+}
 
-        if (capturesOnly) continue;
+template<GenType Type, bool Legal, class T>
+static void generateInto(const Board& board, MoveList<T>& moves) {
+    moves.clear();
+    appendInto<Type,Legal>(board, moves);
+}
 
-        // Castling
-        Color opp=(side==WHITE)?BLACK:WHITE;
-        int cr=board.castlingRights();
-        if (side==WHITE) {
-            // Kingside
-            if ((cr&1) && board.pieceAt(5)==0 && board.pieceAt(6)==0 &&
-                !board.isSquareAttacked(4,opp)&&!board.isSquareAttacked(5,opp)&&!board.isSquareAttacked(6,opp)) {
-                moves.push_back(Move(4,6,FLAG_CASTLE));
-            }
-            // Queenside
-            if ((cr&2) && board.pieceAt(3)==0 && board.pieceAt(2)==0 && board.pieceAt(1)==0 &&
-                !board.isSquareAttacked(4,opp)&&!board.isSquareAttacked(3,opp)&&!board.isSquareAttacked(2,opp)) {
-                moves.push_back(Move(4,2,FLAG_CASTLE));
-            }
-        } else {
-            if ((cr&4) && board.pieceAt(61)==0 && board.pieceAt(62)==0 &&
-                !board.isSquareAttacked(60,opp)&&!board.isSquareAttacked(61,opp)&&!board.isSquareAttacked(62,opp)) {
-                moves.push_back(Move(60,62,FLAG_CASTLE));
-            }
-            if ((cr&8) && board.pieceAt(59)==0 && board.pieceAt(58)==0 && board.pieceAt(57)==0 &&
-                !board.isSquareAttacked(60,opp)&&!board.isSquareAttacked(59,opp)&&!board.isSquareAttacked(58,opp)) {
-                moves.push_back(Move(60,58,FLAG_CASTLE));
-            }
-        }
-    }
+void MoveGen::generateMoves(const Board& board, MoveList<Move>& moves) {
+    generateInto<GEN_ALL,false>(board, moves);
+}
+void MoveGen::generateCaptures(const Board& board, MoveList<Move>& moves) {
+    generateInto<GEN_CAPTURES,false>(board, moves);
+}
+
+void MoveGen::generateScoredMoves(const Board& board, MoveList<ScoredMove>& moves, GenType type) {
+    moves.clear();
+    appendScoredMoves(board, moves, type);
+}
+
+void MoveGen::appendScoredMoves(const Board& board, MoveList<ScoredMove>& moves, GenType type) {
+    if (type==GEN_CAPTURES) appendInto<GEN_CAPTURES,false>(board, moves);
+    else if (type==GEN_QUIETS) appendInto<GEN_QUIETS,false>(board, moves);
+    else appendInto<GEN_ALL,false>(board, moves);
+}
+
+void MoveGen::generateLegalMoves(const Board& board, MoveList<Move>& moves, GenType type) {
+    if (type==GEN_CAPTURES) generateInto<GEN_CAPTURES,true>(board, moves);
+    else if (type==GEN_QUIETS) generateInto<GEN_QUIETS,true>(board, moves);
+    else generateInto<GEN_ALL,true>(board, moves);
 }
 
 std::vector<Move> MoveGen::generateMoves(const Board& board) {
-    std::vector<Move> moves;
-    moves.reserve(64);
-    addPawnMoves(board,moves,false);
-    addKnightMoves(board,moves,false);
-    addSliding(board,moves,false);
-    addKingMoves(board,moves,false);
-    return moves;
+    MoveList<Move> list;
+    generateMoves(board, list);
+    return std::vector<Move>(list.begin(), list.end());
 }
 
 std::vector<Move> MoveGen::generateCaptures(const Board& board) {
-    std::vector<Move> moves;
-    moves.reserve(16);
-    addPawnMoves(board,moves,true);
-    addKnightMoves(board,moves,true);
-    addSliding(board,moves,true);
-    addKingMoves(board,moves,true);
-    return moves;
+    MoveList<Move> list;
+    generateCaptures(board, list);
+    return std::vector<Move>(list.begin(), list.end());
 }
 
-std::vector<Move> MoveGen::generateLegalMoves(Board& board) {
-    auto pseudo = generateMoves(board);
-    std::vector<Move> legal;
-    legal.reserve(pseudo.size());
-    for (auto& m : pseudo) {
-        if (board.makeMove(m)) {
-            legal.push_back(m);
-            board.unmakeMove();
-        }
-    }
-    return legal;
+std::vector<Move> MoveGen::generateLegalMoves(const Board& board) {
+    MoveList<Move> list;
+    generateLegalMoves(board, list);
+    return std::vector<Move>(list.begin(), list.end());
 }
 
 uint64_t MoveGen::perft(Board& board, int depth) {
     if (depth==0) return 1;
-    auto moves = generateMoves(board);
+    MoveList<Move> moves;
+    generateLegalMoves(board, moves);
+    // Every move in the list is legal, so the last ply is just a count
+    if (depth==1) return moves.size();
     uint64_t nodes=0;
-    for (auto& m : moves) {
-        if (board.makeMove(m)) {
-            nodes += perft(board,depth-1);
-            board.unmakeMove();
-        }
+    for (Move m : moves) {
+        board.doMove(m);
+        nodes += perft(board,depth-1);
+        board.unmakeMove();
     }
     return nodes;
 }
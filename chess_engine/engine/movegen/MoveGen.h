@@ -1,15 +1,64 @@
 #pragma once
 #include "../board/Board.h"
+#include <cassert>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+// Fixed-capacity move list that lives on the stack, so generating moves
+// never allocates. 256 slots cover every pseudo-legal list seen in
+// practice (the most legal moves known in a position is 218). The slots
+// sit in a union so constructing a list doesn't zero-fill them (Move and
+// ScoredMove have member initialisers); only [0, count) is ever read.
+template<class T = Move>
+struct MoveList {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                  "MoveList slots are assigned without being constructed");
+    static constexpr int MAX_MOVES = 256;
+    union { T moves[MAX_MOVES]; };
+    int count = 0;
+
+    MoveList() {}
+
+    void push_back(const T& m) { assert(count < MAX_MOVES); moves[count++] = m; }
+    template<class... Args> void emplace_back(Args&&... args) {
+        assert(count < MAX_MOVES);
+        moves[count++] = T(std::forward<Args>(args)...);
+    }
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    T& operator[](int i) { return moves[i]; }
+    const T& operator[](int i) const { return moves[i]; }
+    T* begin() { return moves; }
+    T* end() { return moves + count; }
+    const T* begin() const { return moves; }
+    const T* end() const { return moves + count; }
+};
+
+// Which moves to generate: captures are captures, capture-promotions and
+// en passant; quiets are everything else (pushes, push-promotions, castling)
+enum GenType { GEN_ALL, GEN_CAPTURES, GEN_QUIETS };
+
 class MoveGen {
 public:
-    // Generate all pseudo-legal moves
-    static std::vector<Move> generateMoves(const Board& board);
+    // Generate all pseudo-legal moves into a cleared list
+    static void generateMoves(const Board& board, MoveList<Move>& moves);
     // Generate only captures (for quiescence)
+    static void generateCaptures(const Board& board, MoveList<Move>& moves);
+    // Same pseudo-legal moves with the moving and captured pieces filled in
+    static void generateScoredMoves(const Board& board, MoveList<ScoredMove>& moves, GenType type = GEN_ALL);
+    // Append them after the moves already in the list instead
+    static void appendScoredMoves(const Board& board, MoveList<ScoredMove>& moves, GenType type);
+    // Generate legal moves only: check evasions when in check, pinned
+    // pieces on their pin ray, en passant tested for uncovered checks
+    static void generateLegalMoves(const Board& board, MoveList<Move>& moves, GenType type = GEN_ALL);
+
+    // Vector forms for the CLI and PGN code, off the search path
+    static std::vector<Move> generateMoves(const Board& board);
     static std::vector<Move> generateCaptures(const Board& board);
-    // Generate all legal moves
-    static std::vector<Move> generateLegalMoves(Board& board);
+    static std::vector<Move> generateLegalMoves(const Board& board);
+
     // Perft for testing
     static uint64_t perft(Board& board, int depth);
 };
@@ -0,0 +1,117 @@
+#include "MovePicker.h"
+#include "../eval/Eval.h"
+
+MovePicker::MovePicker(const Board& b, Move tt, const Move* k, const int (*h)[64])
+    : board(b), ttMove(tt), killers(k), history(h) {
+    // A TT move from another position (key collision) must not be tried
+    stage = board.isPseudoLegal(ttMove) ? TT_MOVE : INIT_CAPTURES;
+}
+
+MovePicker::MovePicker(const Board& b) : board(b), stage(QS_INIT_CAPTURES) {}
+
+ScoredMove MovePicker::withPieces(Move m) const {
+    int cap = m.flags()==FLAG_EP ? makePiece(board.sideToMove()==WHITE?BLACK:WHITE, PAWN) : board.pieceAt(m.to());
+    return ScoredMove(m, board.pieceAt(m.from()), cap);
+}
+
+bool MovePicker::isCapture(Move m) const {
+    return board.pieceAt(m.to()) || m.flags()==FLAG_EP;
+}
+
+// MVV-LVA
+void MovePicker::scoreCaptures() {
+    for (int i = 0; i < captureEnd; i++) {
+        ScoredMove& sm = moves[i];
+        sm.score = Eval::materialValue(sm.captured)*10 - Eval::materialValue(sm.piece);
+    }
+}
+
+// Push-promotions first, the rest by history
+void MovePicker::scoreQuiets() {
+    for (int i = captureEnd; i < moves.size(); i++) {
+        ScoredMove& sm = moves[i];
+        Move m = sm.move;
+        sm.score = m.flags()==FLAG_PROMO ? (1<<30) + m.promo() : history[m.from()][m.to()];
+    }
+}
+
+ScoredMove MovePicker::pickBest(MoveList<ScoredMove>& list, int& cur) {
+    int best = cur;
+    for (int i = cur+1; i < list.size(); i++)
+        if (list[i].score > list[best].score) best = i;
+    std::swap(list[cur], list[best]);
+    return list[cur++];
+}
+
+ScoredMove MovePicker::next() {
+    switch (stage) {
+    case TT_MOVE:
+        stage = INIT_CAPTURES;
+        return withPieces(ttMove);
+
+    case INIT_CAPTURES:
+        MoveGen::generateScoredMoves(board, moves, GEN_CAPTURES);
+        captureEnd = moves.size();
+        scoreCaptures();
+        cur = badEnd = 0;
+        stage = GOOD_CAPTURES;
+        [[fallthrough]];
+    case GOOD_CAPTURES:
+        while (cur < captureEnd) {
+            ScoredMove sm = pickBest(moves, cur);
+            if (sm.move == ttMove) continue;
+            // Losing captures wait until after the quiets
+            if (!board.seeGE(sm.move, 0)) { moves[badEnd++] = sm; continue; }
+            return sm;
+        }
+        stage = KILLERS;
+        killerIndex = 0;
+        [[fallthrough]];
+    case KILLERS:
+        while (killerIndex < 2) {
+            Move k = killers[killerIndex++];
+            if (killerIndex==2 && k==killers[0]) break; // both slots can hold one move
+            if (k != ttMove && !isCapture(k) && board.isPseudoLegal(k)) return withPieces(k);
+        }
+        stage = INIT_QUIETS;
+        [[fallthrough]];
+    case INIT_QUIETS:
+        MoveGen::appendScoredMoves(board, moves, GEN_QUIETS);
+        scoreQuiets();
+        cur = captureEnd;
+        stage = QUIETS;
+        [[fallthrough]];
+    case QUIETS:
+        while (cur < moves.size()) {
+            ScoredMove sm = pickBest(moves, cur);
+            if (sm.move == ttMove || sm.move == killers[0] || sm.move == killers[1]) continue;
+            return sm;
+        }
+        stage = BAD_CAPTURES;
+        cur = 0;
+        [[fallthrough]];
+    case BAD_CAPTURES:
+        // Already in picking order
+        if (cur < badEnd) return moves[cur++];
+        stage = DONE;
+        return ScoredMove();
+
+    case QS_INIT_CAPTURES:
+        MoveGen::generateScoredMoves(board, moves, GEN_CAPTURES);
+        captureEnd = moves.size();
+        scoreCaptures();
+        cur = 0;
+        stage = QS_CAPTURES;
+        [[fallthrough]];
+    case QS_CAPTURES:
+        // Captures that lose material can't raise alpha over stand pat
+        while (cur < captureEnd) {
+            ScoredMove sm = pickBest(moves, cur);
+            if (board.seeGE(sm.move, 0)) return sm;
+        }
+        stage = DONE;
+        [[fallthrough]];
+    default:
+        return ScoredMove();
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "../board/Board.h"
+#include "../movegen/MoveGen.h"
+
+// Hands out the moves of a node one at a time, best first, doing only the
+// work the node reaches: the TT move is tried before anything is
+// generated, captures are generated and scored only if it doesn't cut
+// off, quiets only after the good captures and killers. Each stage picks
+// its best remaining move instead of sorting the whole list.
+//
+// Moves are pseudo-legal; the caller still tests isLegal.
+class MovePicker {
+public:
+    // Main search: TT move, good captures (SEE >= 0, MVV-LVA order),
+    // killers, quiets by history, then the SEE-losing captures
+    MovePicker(const Board& board, Move ttMove, const Move* killers, const int (*history)[64]);
+    // Quiescence: good captures only
+    explicit MovePicker(const Board& board);
+
+    // Next move, or a null move when the node is exhausted
+    ScoredMove next();
+
+private:
+    enum Stage {
+        TT_MOVE, INIT_CAPTURES, GOOD_CAPTURES, KILLERS, INIT_QUIETS, QUIETS, BAD_CAPTURES,
+        QS_INIT_CAPTURES, QS_CAPTURES, DONE
+    };
+
+    const Board& board;
+    Move ttMove;
+    const Move* killers = nullptr;
+    const int (*history)[64] = nullptr;
+    int stage;
+    int cur = 0, badEnd = 0, captureEnd = 0, killerIndex = 0;
+    // One list for the whole node: captures in [0, captureEnd), with the
+    // SEE-losing ones moved to the front ([0, badEnd)) as the good-capture
+    // stage passes them, then the quiets appended after them. Quiescence
+    // only ever fills the capture part.
+    MoveList<ScoredMove> moves;
+
+    ScoredMove withPieces(Move m) const;
+    bool isCapture(Move m) const;
+    void scoreCaptures();
+    void scoreQuiets();
+    // Swaps the best-scored move in [cur, list end) to cur and returns it
+    static ScoredMove pickBest(MoveList<ScoredMove>& list, int& cur);
+};
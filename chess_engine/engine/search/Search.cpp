@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <iostream>
 #include <cstring>
+#include <cstdlib>
 
 Search::Search() : shouldStop(false), timeLimit(3.0), tt(TT_SIZE) {
     clearHeuristics();
@@ -43,33 +44,6 @@ static int ttScore(const TTEntry* e, int ply) {
     return s;
 }
 
-int Search::scoreCapture(const Board& board, Move m) {
-    int cap = board.pieceAt(m.to());
-    int atk = board.pieceAt(m.from());
-    if (!cap) return 0;
-    // MVV-LVA
-    return Eval::materialValue(cap)*10 - Eval::materialValue(atk);
-}
-
-int Search::moveScore(const Board& board, Move m, Move ttMove, int ply) {
-    if (m == ttMove) return 100000;
-    int cap = board.pieceAt(m.to());
-    if (cap) return 10000 + scoreCapture(board, m);
-    if (m.flags()==FLAG_EP) return 9000;
-    if (m.flags()==FLAG_PROMO) return 8000 + m.promo()*100;
-    if (ply < 128) {
-        if (killers[ply][0] == m) return 7000;
-        if (killers[ply][1] == m) return 6900;
-    }
-    return history[m.from()][m.to()];
-}
-
-void Search::orderMoves(Board& board, std::vector<Move>& moves, Move ttMove, int ply) {
-    std::sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
-        return moveScore(board, a, ttMove, ply) > moveScore(board, b, ttMove, ply);
-    });
-}
-
 int Search::quiesce(Board& board, int alpha, int beta, int ply) {
     nodesSearched++;
     if (timeUp()) return alpha;
@@ -80,14 +54,13 @@ int Search::quiesce(Board& board, int alpha, int beta, int ply) {
     if (stand >= beta) return beta;
     if (stand > alpha) alpha = stand;
 
-    auto caps = MoveGen::generateCaptures(board);
-    // Order captures by MVV-LVA
-    std::sort(caps.begin(), caps.end(), [&](Move a, Move b) {
-        return scoreCapture(board, a) > scoreCapture(board, b);
-    });
-
-    for (auto& m : caps) {
-        if (!board.makeMove(m)) continue;
+    // SEE-winning captures by MVV-LVA
+    MovePicker picker(board);
+    CheckInfo ci = board.checkInfo();
+    for (ScoredMove sm = picker.next(); !sm.move.isNull(); sm = picker.next()) {
+        Move m = sm.move;
+        if (!board.isLegal(m, ci)) continue;
+        board.doMove(m);
         int score = -quiesce(board, -beta, -alpha, ply+1);
         board.unmakeMove();
         if (score >= beta) return beta;
@@ -102,6 +75,13 @@ int Search::alphaBeta(Board& board, int depth, int alpha, int beta, int ply, boo
 
     if (board.isDraw()) return Eval::DRAW;
 
+    // We can move back into a position from earlier in the search, so this
+    // node is worth at least a draw
+    if (ply > 0 && alpha < Eval::DRAW && board.hasUpcomingRepetition(ply)) {
+        alpha = Eval::DRAW;
+        if (alpha >= beta) return alpha;
+    }
+
     uint64_t key = board.zobrist();
     Move ttMove;
     auto* tte = probeTT(key);
@@ -118,46 +98,55 @@ int Search::alphaBeta(Board& board, int depth, int alpha, int beta, int ply, boo
 
     if (depth <= 0) return quiesce(board, alpha, beta, ply);
 
-    bool inCheck = board.isInCheck(board.sideToMove());
+    CheckInfo ci = board.checkInfo();
+    bool inCheck = (ci.checkers != 0);
 
-    // Null move pruning
-    if (nullMoveAllowed && !inCheck && depth >= 3) {
-        // Check we have non-pawn material
+    // Null move pruning: if passing still fails high, the node almost
+    // certainly would too. Skipped at the root, in check, near mate scores
+    // and without non-pawn material (zugzwang risk).
+    if (nullMoveAllowed && !inCheck && depth >= 3 && ply > 0 &&
+        std::abs(beta) < Eval::CHECKMATE - 300) {
         Color c = board.sideToMove();
-        int minors = board.countPiece(c,KNIGHT)+board.countPiece(c,BISHOP)+
-                     board.countPiece(c,ROOK)+board.countPiece(c,QUEEN);
-        if (minors > 0) {
-            // Make null move by just switching side
-            board.stateHistory.push_back(board.getState());
-            // Manually toggle side - we need to access Board internals
-            // Instead we'll use a different approach - skip if board doesn't support it
-            // For now, skip null move and implement via a passthrough
-            board.stateHistory.pop_back();
+        int staticEval = Eval::evaluate(board);
+        if (c == BLACK) staticEval = -staticEval;
+        if (board.hasNonPawnMaterial(c) && staticEval >= beta) {
+            int R = 3 + depth / 6; // adaptive reduction
+            board.makeNullMove();
+            int score = -alphaBeta(board, depth - 1 - R, -beta, -beta + 1, ply + 1, false);
+            board.unmakeNullMove();
+            if (timeUp()) return alpha;
+            if (score >= beta) {
+                // Don't return unproven mate scores from a null search
+                if (score >= Eval::CHECKMATE - 300) score = beta;
+                if (depth < NULL_VERIFY_DEPTH) return score;
+                // Deep nodes: verify with a reduced search without null
+                // moves, which catches zugzwang positions
+                int v = alphaBeta(board, depth - 1 - R, beta - 1, beta, ply, false);
+                if (v >= beta) return score;
+            }
         }
     }
 
-    auto moves = MoveGen::generateMoves(board);
-    orderMoves(board, moves, ttMove, ply);
-
-    if (moves.empty()) {
-        if (inCheck) return -(Eval::CHECKMATE - ply); // checkmate
-        return Eval::DRAW; // stalemate
-    }
+    static const Move NO_KILLERS[2];
+    MovePicker picker(board, ttMove, ply < 128 ? killers[ply] : NO_KILLERS, history);
 
     int origAlpha = alpha;
     Move bestMove;
     int moveCount = 0;
 
-    for (auto& m : moves) {
-        if (!board.makeMove(m)) continue;
+    for (ScoredMove sm = picker.next(); !sm.move.isNull(); sm = picker.next()) {
+        Move m = sm.move;
+        if (!board.isLegal(m, ci)) continue;
+        bool givesCheck = board.givesCheck(m, ci);
+        board.doMove(m);
         moveCount++;
 
         int score;
-        bool isCapture = (board.stateHistory.back().capturedPiece != 0);
+        bool isCapture = (sm.captured != 0);
         
-        // Late Move Reductions
+        // Late Move Reductions (never for captures, promotions or checks)
         int newDepth = depth - 1;
-        if (moveCount > 4 && depth >= 3 && !inCheck && !isCapture && m.flags()!=FLAG_PROMO) {
+        if (moveCount > 4 && depth >= 3 && !inCheck && !isCapture && m.flags()!=FLAG_PROMO && !givesCheck) {
             int R = 1 + (moveCount > 8 ? 1 : 0) + (depth > 6 ? 1 : 0);
             score = -alphaBeta(board, newDepth - R, -alpha-1, -alpha, ply+1, true);
             if (score > alpha) {
@@ -186,8 +175,8 @@ int Search::alphaBeta(Board& board, int depth, int alpha, int beta, int ply, boo
             }
         }
         if (alpha >= beta) {
-            // Killer move
-            if (!board.pieceAt(m.to()) && ply < 128) {
+            // Killer move (kept distinct from the other slot)
+            if (!sm.captured && ply < 128 && killers[ply][0] != m) {
                 killers[ply][1] = killers[ply][0];
                 killers[ply][0] = m;
             }
@@ -197,6 +186,12 @@ int Search::alphaBeta(Board& board, int depth, int alpha, int beta, int ply, boo
         }
     }
 
+    // No legal move: checkmate or stalemate
+    if (moveCount == 0) {
+        if (inCheck) return -(Eval::CHECKMATE - ply);
+        return Eval::DRAW;
+    }
+
     if (!timeUp() && !bestMove.isNull()) {
         int flag = (alpha <= origAlpha) ? 2 : (alpha >= beta) ? 1 : 0;
         storeTT(key, depth, alpha, bestMove, flag, ply);
@@ -214,7 +209,8 @@ Move Search::findBestMove(Board& board, double timeLimitSec, int maxDepth) {
     clearHeuristics();
 
     // Check for single legal move
-    auto legalMoves = MoveGen::generateLegalMoves(board);
+    MoveList<Move> legalMoves;
+    MoveGen::generateLegalMoves(board, legalMoves);
     if (legalMoves.empty()) return Move();
     if (legalMoves.size() == 1) return legalMoves[0];
 
@@ -2,6 +2,7 @@
 #include "../board/Board.h"
 #include "../movegen/MoveGen.h"
 #include "../eval/Eval.h"
+#include "MovePicker.h"
 #include <chrono>
 #include <unordered_map>
 #include <vector>
@@ -39,6 +40,9 @@ private:
     static constexpr int TT_SIZE = (1<<20); // 1M entries
     std::vector<TTEntry> tt;
 
+    // Null move searches at or above this depth are verified
+    static constexpr int NULL_VERIFY_DEPTH = 12;
+
     // Killer moves [ply][2]
     Move killers[128][2];
     // History heuristic [from][to]
@@ -50,11 +54,7 @@ private:
     int alphaBeta(Board& board, int depth, int alpha, int beta, int ply, bool nullMoveAllowed);
     int quiesce(Board& board, int alpha, int beta, int ply);
 
-    void orderMoves(Board& board, std::vector<Move>& moves, Move ttMove, int ply);
-    int moveScore(const Board& board, Move m, Move ttMove, int ply);
 
     void storeTT(uint64_t key, int depth, int score, Move best, int flag, int ply);
     TTEntry* probeTT(uint64_t key);
-
-    static int scoreCapture(const Board& board, Move m);
 };
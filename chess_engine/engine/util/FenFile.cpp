@@ -0,0 +1,58 @@
+#include "FenFile.h"
+#include <cstdio>
+#include <cstring>
+
+long long FenFile::forEach(const std::string& filename,
+                           const std::function<void(const Board&, std::string_view)>& fn,
+                           long long* malformed) {
+    FILE* f = std::fopen(filename.c_str(), "rb");
+    if (!f) return -1;
+
+    static constexpr size_t BLOCK = 1 << 20;
+    std::vector<char> buf(BLOCK);
+    size_t filled = 0; // bytes of buf holding unparsed data
+    long long loaded = 0, bad = 0;
+    Board board;
+
+    auto parseLine = [&](const char* p, size_t n) {
+        while (n && (p[n-1]=='\r' || p[n-1]==' ')) n--;
+        while (n && (*p==' ' || *p=='\t')) { p++; n--; }
+        if (!n || *p=='#') return;
+        std::string_view line(p, n);
+        if (board.loadFEN(line)) { fn(board, line); loaded++; }
+        else bad++;
+    };
+
+    while (true) {
+        size_t got = std::fread(buf.data() + filled, 1, buf.size() - filled, f);
+        filled += got;
+        bool eof = (got == 0);
+
+        // Parse every complete line in the buffer
+        const char* p = buf.data();
+        const char* end = buf.data() + filled;
+        while (const char* nl = (const char*)std::memchr(p, '\n', end - p)) {
+            parseLine(p, nl - p);
+            p = nl + 1;
+        }
+        if (eof) {
+            parseLine(p, end - p); // last line without a newline
+            break;
+        }
+        // Keep the partial line for the next block, growing the buffer
+        // only for a line longer than a whole block
+        filled = end - p;
+        std::memmove(buf.data(), p, filled);
+        if (filled == buf.size()) buf.resize(buf.size() * 2);
+    }
+    std::fclose(f);
+    if (malformed) *malformed = bad;
+    return loaded;
+}
+
+long long FenFile::loadAll(const std::string& filename, std::vector<Position>& out,
+                           long long* malformed) {
+    return forEach(filename, [&](const Board& b, std::string_view) {
+        out.push_back(b.position());
+    }, malformed);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "../board/Board.h"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Bulk reader for FEN/EPD files (one position per line), for tuning and
+// batch analysis. The file is read in large blocks and each line parsed in
+// place with Board::loadFEN, so no per-line allocation takes place.
+class FenFile {
+public:
+    // Calls fn(board, line) for every well-formed line; the full line is
+    // passed so EPD operations (bm, id, c9 ...) can be read by the caller.
+    // Blank lines and '#' comments are skipped, malformed lines counted in
+    // *malformed. Returns the number of positions loaded, or -1 if the file
+    // can't be opened.
+    static long long forEach(const std::string& filename,
+                             const std::function<void(const Board&, std::string_view)>& fn,
+                             long long* malformed = nullptr);
+
+    // Load every position of the file into out
+    static long long loadAll(const std::string& filename, std::vector<Position>& out,
+                             long long* malformed = nullptr);
+};
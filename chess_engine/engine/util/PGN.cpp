@@ -76,12 +76,9 @@ std::string PGN::moveToSAN(Board& board, Move m) {
         san += promoChars[m.promo()];
     }
 
-    // Check/checkmate indicator
-    if (board.makeMove(m)) {
-        bool inCheck = board.isInCheck(board.sideToMove());
-        auto resp = MoveGen::generateLegalMoves(board);
-        if (inCheck && resp.empty()) san+='#';
-        else if (inCheck) san+='+';
+    // Check/checkmate indicator: only checking moves need the reply list
+    if (board.givesCheck(m) && board.makeMove(m)) {
+        san += board.hasLegalMove() ? '+' : '#';
         board.unmakeMove();
     }
 
@@ -0,0 +1,318 @@
+#include "../engine/board/Board.h"
+#include "../engine/movegen/MoveGen.h"
+#include "../engine/eval/Eval.h"
+#include "../engine/search/MovePicker.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+static int pass = 0, fail = 0;
+
+static void check(bool ok, const std::string& name) {
+    std::cout << (ok?"[PASS]":"[FAIL]") << " " << name << "\n";
+    if (ok) pass++; else fail++;
+}
+
+// Legal move by coordinates ("e2e4", "e7e8q"), or a null move if none
+static Move findMove(const Board& board, const std::string& uci) {
+    for (Move m : MoveGen::generateLegalMoves(board)) {
+        std::string s;
+        s += (char)('a' + m.from()%8); s += (char)('1' + m.from()/8);
+        s += (char)('a' + m.to()%8);   s += (char)('1' + m.to()/8);
+        if (m.flags()==FLAG_PROMO) s += "nbrq"[m.promo()];
+        if (s == uci) return m;
+    }
+    return Move();
+}
+
+struct SeeCase {
+    const char* fen;
+    const char* move;
+    int expected;
+};
+
+// Known exchanges: undefended pawn, pawn defended by a knight with x-ray
+// backing on both sides, en passant, a promotion, a queen taking a
+// defended pawn
+static const SeeCase SEE_CASES[] = {
+    {"1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", Eval::PAWN_VAL},
+    {"1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5", Eval::PAWN_VAL - Eval::KNIGHT_VAL},
+    {"4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", Eval::PAWN_VAL},
+    {"7k/3P4/8/8/8/8/8/4K3 w - - 0 1", "d7d8q", Eval::QUEEN_VAL - Eval::PAWN_VAL},
+    {"4k3/8/2p5/3p4/8/8/3Q4/4K3 w - - 0 1", "d2d5", Eval::PAWN_VAL - Eval::QUEEN_VAL},
+};
+
+// Each one is loadable except for the field named
+static const char* BAD_FENS[] = {
+    "4k3/8/8/3P4/8/8/8/4K3 w - e6 0 1",          // no pawn in front of the ep square
+    "4k3/8/8/3Pp3/8/8/8/4K3 b - e6 0 1",         // ep square on the wrong side
+    "4k3/4p3/8/3Pp3/8/8/8/4K3 w - e6 0 1",       // pawn's start square occupied
+    "4k3/8/8/8/8/8/8/4K3 w K - 0 1",             // castling right without the rook
+    "4k3/8/8/8/8/8/8/R4K2 w Q - 0 1",            // castling right with the king moved
+    "8/8/8/8/8/8/8/4K3 w - - 0 1",               // no black king
+    "4k3/8/8/8/8/8/8/4K1K1 w - - 0 1",           // two white kings
+    "4k2P/8/8/8/8/8/8/4K3 w - - 0 1",            // pawn on the last rank
+    "4k3/8/8/8/8/8/8/4K3 x - - 0 1",             // bad side
+    "4k3/8/8/8/8/8/8/4K3 w - e9 0 1",            // bad ep field
+    "4k3/8/8/8/8/8/8/4K4 w - - 0 1",             // rank too long
+    "rnbqkbnr/pppppppp/QQQQQQQQ/NNNNNNNN/BBBBBBBB/rrrrrrrr/PPPPPPPP/RNBQKBNR w - - 0 1", // over 16 pieces a side
+    "4k3/8/8/8/8/8/4R3/4K3 w - - 0 1",           // side not to move in check
+};
+
+static const char* ROUND_TRIP_FENS[] = {
+    Board::START_FEN,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 37 300",
+};
+
+static void testSee() {
+    for (auto& tc : SEE_CASES) {
+        Board board;
+        board.loadFEN(tc.fen);
+        Move m = findMove(board, tc.move);
+        int got = m.isNull() ? -1 : board.see(m);
+        check(got == tc.expected && board.seeGE(m, tc.expected) && !board.seeGE(m, tc.expected+1),
+              std::string("SEE ") + tc.move + " = " + std::to_string(got) + " expected " + std::to_string(tc.expected));
+    }
+}
+
+static void testBadFens() {
+    for (const char* fen : BAD_FENS) {
+        Board board;
+        bool rejected = !board.loadFEN(fen) && board.toFEN() == Board::START_FEN;
+        check(rejected, std::string("reject ") + fen);
+    }
+}
+
+static void testPackRoundTrip() {
+    for (const char* fen : ROUND_TRIP_FENS) {
+        Board a, b;
+        a.loadFEN(fen);
+        PackedBoard p = a.pack();
+        bool ok = b.unpack(p) && b.toFEN() == fen && b.zobrist() == a.zobrist()
+               && b.pawnKey() == a.pawnKey() && b.materialKey() == a.materialKey() && b.pack() == p;
+        check(ok, std::string("pack/unpack ") + fen);
+    }
+
+    // Records a FEN would be rejected for: a stray ep square, castling
+    // rights without the rook
+    Board board;
+    board.loadFEN("4k3/8/8/3P4/8/8/8/4K2R w K - 0 1");
+    PackedBoard p = board.pack();
+    PackedBoard badEp = p, badCastle = p;
+    badEp.bytes[25] = 44; // e6
+    badCastle.bytes[24] |= 2 << 1; // Q
+    check(!board.unpack(badEp) && !board.unpack(badCastle) && board.pack() == p, "unpack rejects inconsistent records");
+}
+
+static void testRepetition() {
+    Board board;
+    const char* shuffle[] = {"g1f3", "g8f6", "f3g1", "f6g8"};
+    for (const char* uci : shuffle) board.makeMove(findMove(board, uci));
+    bool twice = !board.isDraw();
+    for (const char* uci : shuffle) board.makeMove(findMove(board, uci));
+    check(twice && board.isDraw(), "knight shuffle threefold");
+
+    // The same position reached again through two null moves does not
+    // count: repetition detection stops at a null move
+    Board nulls;
+    for (const char* uci : shuffle) nulls.makeMove(findMove(nulls, uci));
+    nulls.makeNullMove();
+    nulls.makeNullMove();
+    bool ok = nulls.zobrist() == Board().zobrist() && !nulls.isDraw();
+    nulls.unmakeNullMove();
+    nulls.unmakeNullMove();
+    for (const char* uci : shuffle) nulls.makeMove(findMove(nulls, uci));
+    check(ok && nulls.isDraw(), "repetition ignores positions before a null move");
+}
+
+// After Nf3 Nf6 Ng1, Black's Ng8 would repeat the start position three
+// plies back: only a search at least that deep has the start inside it
+static void testUpcomingRepetition() {
+    Board board;
+    for (const char* uci : {"g1f3", "g8f6", "f3g1"}) board.makeMove(findMove(board, uci));
+    bool ok = board.hasUpcomingRepetition(4) && board.hasUpcomingRepetition(10)
+           && !board.hasUpcomingRepetition(3) && !board.hasUpcomingRepetition(1);
+    check(ok, "upcoming repetition only above ply 3");
+
+    // A pawn move cuts the cycle off
+    board.makeMove(findMove(board, "e7e5"));
+    board.makeMove(findMove(board, "g1f3"));
+    board.makeMove(findMove(board, "f6g8"));
+    check(!board.hasUpcomingRepetition(10), "no upcoming repetition across an irreversible move");
+}
+
+// givesCheck against making the move, over every legal move two plies deep
+static void testGivesCheck() {
+    static const char* fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    };
+    int mismatches = 0;
+    for (const char* fen : fens) {
+        Board board;
+        board.loadFEN(fen);
+        for (Move m1 : MoveGen::generateLegalMoves(board)) {
+            board.doMove(m1);
+            for (Move m2 : MoveGen::generateLegalMoves(board)) {
+                bool predicted = board.givesCheck(m2);
+                board.doMove(m2);
+                if (predicted != board.isInCheck(board.sideToMove())) mismatches++;
+                board.unmakeMove();
+            }
+            board.unmakeMove();
+        }
+    }
+    check(mismatches == 0, "givesCheck matches make/isInCheck (" + std::to_string(mismatches) + " mismatches)");
+}
+
+// Mate, stalemate and the evasions hasLegalMove must find or rule out
+static void testGameEnd() {
+    struct EndCase { const char* fen; bool mate, stalemate; const char* name; };
+    static const EndCase cases[] = {
+        {"rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3", true, false, "fool's mate"},
+        {"7k/5Q2/6K1/8/8/8/8/8 b - - 0 1", false, true, "stalemate"},
+        {"4R2k/5Npp/8/8/8/8/8/6K1 b - - 0 1", true, false, "double-check mate"},
+        // b2-b4 checks; the king is boxed in and only c4xb3 e.p. removes the checker
+        {"8/8/pp6/kp6/nPp5/P7/8/7K b - b3 0 1", false, false, "en passant is the only escape"},
+        {"8/8/pp6/kp6/nPp5/P7/8/7K b - - 0 1", true, false, "same without the e.p. right"},
+        // Nf6 could block on g8 or e8 but is pinned by Bc3
+        {"R6k/7p/4Nn2/8/8/2B5/8/6K1 b - - 0 1", true, false, "only block is by a pinned piece"},
+        {"R6k/7p/4Nn2/8/8/8/8/6K1 b - - 0 1", false, false, "same block without the pin"},
+    };
+    for (auto& tc : cases) {
+        Board board;
+        bool ok = board.loadFEN(tc.fen) && board.isCheckmate() == tc.mate && board.isStalemate() == tc.stalemate
+               && board.hasLegalMove() == !MoveGen::generateLegalMoves(board).empty();
+        check(ok, std::string("game end: ") + tc.name);
+    }
+}
+
+// hasLegalMove against the legal generator at every node of a small tree
+static int countLegalMoveMismatches(Board& board, int depth, int& nodes) {
+    nodes++;
+    MoveList<Move> moves;
+    MoveGen::generateLegalMoves(board, moves);
+    int mismatches = board.hasLegalMove() != !moves.empty();
+    if (depth == 0) return mismatches;
+    for (Move m : moves) {
+        board.doMove(m);
+        mismatches += countLegalMoveMismatches(board, depth-1, nodes);
+        board.unmakeMove();
+    }
+    return mismatches;
+}
+
+static void testHasLegalMove() {
+    struct TreeCase { const char* fen; int depth; };
+    static const TreeCase trees[] = {
+        {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 2},
+        {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 3},
+        {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 2},
+        {"8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 3},
+    };
+    int mismatches = 0, nodes = 0;
+    for (auto& tc : trees) {
+        Board board;
+        board.loadFEN(tc.fen);
+        mismatches += countLegalMoveMismatches(board, tc.depth, nodes);
+    }
+    check(mismatches == 0, "hasLegalMove matches the legal generator over " + std::to_string(nodes)
+          + " nodes (" + std::to_string(mismatches) + " mismatches)");
+}
+
+// Positions for the move-ordering checks: every node one ply below a few
+// perft roots (castling, en passant, promotions, checks)
+template<class Fn>
+static void forEachTestNode(Fn fn) {
+    static const char* fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+    };
+    for (const char* fen : fens) {
+        Board board;
+        board.loadFEN(fen);
+        fn(board);
+        for (Move m : MoveGen::generateLegalMoves(board)) {
+            board.doMove(m);
+            fn(board);
+            board.unmakeMove();
+        }
+    }
+}
+
+// isPseudoLegal accepts exactly the generator's moves, over every encoding
+static void testIsPseudoLegal() {
+    int mismatches = 0, nodes = 0;
+    forEachTestNode([&](const Board& board) {
+        nodes++;
+        static bool generated[65536];
+        std::fill(std::begin(generated), std::end(generated), false);
+        MoveList<Move> moves;
+        MoveGen::generateMoves(board, moves);
+        for (Move m : moves) generated[m.data] = true;
+        for (int d = 1; d < 65536; d++) {
+            Move m;
+            m.data = (uint16_t)d;
+            if (board.isPseudoLegal(m) != generated[d]) mismatches++;
+        }
+    });
+    check(mismatches == 0, "isPseudoLegal matches the generator on " + std::to_string(nodes)
+          + " nodes (" + std::to_string(mismatches) + " mismatches)");
+}
+
+// A picker seeded with a TT move and two killers, one of them a capture,
+// hands out every pseudo-legal move exactly once
+static void testMovePicker() {
+    static int history[64][64];
+    for (int f = 0; f < 64; f++) for (int t = 0; t < 64; t++) history[f][t] = (f*31 + t*17) % 97;
+    int bad = 0, nodes = 0;
+    forEachTestNode([&](const Board& board) {
+        nodes++;
+        MoveList<Move> moves;
+        MoveGen::generateMoves(board, moves);
+        // TT move: the first quiet; killers: the first capture and the last quiet
+        Move ttMove, capture, quiet;
+        for (Move m : moves) {
+            if (board.pieceAt(m.to()) || m.flags()==FLAG_EP) {
+                if (capture.isNull()) capture = m;
+            } else {
+                if (ttMove.isNull()) ttMove = m;
+                quiet = m;
+            }
+        }
+        Move killers[2] = {capture, quiet};
+
+        static int seen[65536];
+        std::fill(std::begin(seen), std::end(seen), 0);
+        MovePicker picker(board, ttMove, killers, history);
+        for (ScoredMove sm = picker.next(); !sm.move.isNull(); sm = picker.next()) seen[sm.move.data]++;
+        int total = 0;
+        for (Move m : moves) { if (seen[m.data] != 1) bad++; total += seen[m.data]; }
+        for (int d = 0; d < 65536; d++) total -= seen[d];
+        if (total != 0) bad++; // a move the generator doesn't produce
+    });
+    check(bad == 0, "MovePicker returns each pseudo-legal move once on " + std::to_string(nodes)
+          + " nodes (" + std::to_string(bad) + " errors)");
+}
+
+int main() {
+    testSee();
+    testBadFens();
+    testPackRoundTrip();
+    testRepetition();
+    testUpcomingRepetition();
+    testGivesCheck();
+    testGameEnd();
+    testHasLegalMove();
+    testIsPseudoLegal();
+    testMovePicker();
+    std::cout << "\n" << pass << "/" << (pass+fail) << " tests passed.\n";
+    return fail > 0 ? 1 : 0;
+}
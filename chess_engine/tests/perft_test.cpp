@@ -1,5 +1,6 @@
 #include "../engine/board/Board.h"
 #include "../engine/movegen/MoveGen.h"
+#include "../engine/board/Attacks.h"
 #include <iostream>
 #include <string>
 
@@ -17,11 +18,29 @@ static const PerftCase CASES[] = {
     {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "Start", 3, 8902},
     {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "Pos2", 1, 48},
     {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "Pos2", 2, 2039},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "Pos2", 3, 97862},
     {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", "Pos3", 1, 14},
     {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", "Pos3", 2, 191},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", "Pos3", 4, 43238},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", "Pos4", 1, 6},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", "Pos4", 3, 9467},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", "Pos5", 1, 44},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", "Pos5", 3, 62379},
+    // Legal generator edge cases: en passant uncovering a check on its
+    // own king, en passant giving check, pins and double checks
+    {"3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", "EpPin", 4, 10138},
+    {"8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", "EpDiag", 4, 10276},
+    {"8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", "EpCheck", 4, 13931},
+    {"8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", "Checks", 4, 23527},
+    {"r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", "Pins", 3, 50509},
 };
 
-int main() {
+int main(int argc, char* argv[]) {
+    // --magic: run on the magic slider backend even where PEXT is
+    // available. Must come before the first Board, which initialises
+    // the tables.
+    Attacks::init(!(argc >= 2 && std::string(argv[1]) == "--magic"));
+    std::cout << "Slider attacks: " << Attacks::backendName() << "\n";
     int pass=0, fail=0;
     for (auto& tc : CASES) {
         Board board;